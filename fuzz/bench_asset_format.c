@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_types.h"
+#include "eos_utils.h"
+#include "native_mocks.h"
+#include "reference.h"
+
+#define INPUTS 256
+#define ROUNDS 2000
+
+typedef uint8_t (*formatter_t)(asset_t *asset, char *out, uint32_t size);
+
+static asset_t inputs[INPUTS];
+static volatile uint32_t sink;
+
+static double time_formatter(formatter_t formatter) {
+    char out[64];
+    uint64_t start = now_ns();
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (uint32_t i = 0; i < INPUTS; i++) {
+            sink += formatter(&inputs[i], out, sizeof(out));
+        }
+    }
+    return (double) (now_ns() - start) / (ROUNDS * INPUTS);
+}
+
+int main(void) {
+    char out[64];
+
+    // Transfers of up to 10^9 EOS, at precision 4
+    for (uint32_t i = 0; i < INPUTS; i++) {
+        uint64_t bits = ((uint64_t) test_random() << 32) | test_random();
+        inputs[i].amount = (int64_t) (bits % 10000000000000ull);
+        inputs[i].symbol = 4 | ((uint64_t) 'E' << 8) | ((uint64_t) 'O' << 16) |
+                           ((uint64_t) 'S' << 24);
+    }
+
+    g_reference_divisions = 0;
+    for (uint32_t i = 0; i < INPUTS; i++) {
+        reference_asset_to_string(&inputs[i], out, sizeof(out));
+    }
+    printf("asset_to_string of EOS amounts\n");
+    printf("  previous: 64-bit divisions per asset: %.1f\n",
+           (double) g_reference_divisions / INPUTS);
+    printf("  previous: %8.1f ns per asset\n", time_formatter(reference_asset_to_string));
+    printf("  current:  %8.1f ns per asset\n", time_formatter(asset_to_string));
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_utils.h"
+#include "native_mocks.h"
+#include "reference.h"
+
+// A compressed public key and its checksum, as displayed by the app
+#define INPUT_SIZE 37
+#define INPUTS     256
+#define ROUNDS     200
+
+typedef bool (*encoder_t)(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz);
+
+static uint8_t inputs[INPUTS][INPUT_SIZE];
+static volatile uint32_t sink;
+
+static double time_encoder(encoder_t encoder) {
+    char out[64];
+    uint64_t start = now_ns();
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (uint32_t i = 0; i < INPUTS; i++) {
+            uint32_t size = sizeof(out);
+            encoder(inputs[i], INPUT_SIZE, out, &size);
+            sink += out[0];
+        }
+    }
+    return (double) (now_ns() - start) / (ROUNDS * INPUTS);
+}
+
+int main(void) {
+    for (uint32_t i = 0; i < INPUTS; i++) {
+        for (uint32_t j = 0; j < INPUT_SIZE; j++) {
+            inputs[i][j] = test_random();
+        }
+    }
+
+    printf("b58enc of %d bytes, ns per call\n", INPUT_SIZE);
+    printf("  previous: %8.1f\n", time_encoder(reference_b58enc));
+    printf("  current:  %8.1f\n", time_encoder(b58enc));
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_parse.h"
+#include "eos_stream.h"
+#include "native_mocks.h"
+
+#define CORPUS_DIRECTORY "ref_corpus/"
+// The first SIGN chunk also holds the signing path
+#define FIRST_CHUNK_SIZE 242
+#define CHUNK_SIZE       255
+#define MAX_TRANSACTION  16384
+
+static const char *const CORPUS[] = {
+    "transaction",
+    "transaction_buyram",
+    "transaction_buyrambytes",
+    "transaction_deleteauth",
+    "transaction_linkauth",
+    "transaction_newaccount",
+    "transaction_refund",
+    "transaction_sellram",
+    "transaction_unknown",
+    "transaction_unlinkauth",
+    "transaction_updateauth",
+    "transaction_vote",
+    "transaction_vote_proxy",
+};
+
+static txProcessingContext_t txProcessingCtx;
+static txProcessingContent_t txContent;
+static cx_sha256_t sha256;
+static cx_sha256_t dataSha256;
+
+// Returns of parseTx and actions reviewed by the last stream_transaction
+static uint32_t parserReturns;
+static uint32_t actions;
+
+/**
+ * Stream the transaction in chunks of the given sizes, as the SIGN command does, and
+ * compute its digest. Return the number of chunks, 0 if the parser fails.
+ */
+static uint32_t stream_transaction(const uint8_t *transaction,
+                                   uint32_t length,
+                                   uint32_t firstChunkSize,
+                                   uint32_t chunkSize,
+                                   uint8_t *digest) {
+    // The parser compacts the hashed data in place, as in G_io_apdu_buffer
+    uint8_t buffer[CHUNK_SIZE];
+    uint32_t offset = 0, chunks = 0;
+    parserStatus_e status = STREAM_PROCESSING;
+
+    parserReturns = 0;
+    actions = 0;
+    initTxContext(&txProcessingCtx, &sha256, &dataSha256, &txContent, 1, false, NULL);
+    while (offset < length && status != STREAM_FINISHED) {
+        uint32_t size = chunks == 0 ? firstChunkSize : chunkSize;
+        if (size > length - offset) {
+            size = length - offset;
+        }
+        memmove(buffer, transaction + offset, size);
+        offset += size;
+        chunks++;
+        status = parseTx(&txProcessingCtx, buffer, size);
+        parserReturns++;
+        // Go on as if every action was approved
+        while (status == STREAM_ACTION_READY || status == STREAM_CONFIRM_PROCESSING) {
+            actions += status == STREAM_ACTION_READY;
+            status = parseTx(&txProcessingCtx, NULL, 0);
+            parserReturns++;
+        }
+        if (status == STREAM_FAULT) {
+            return 0;
+        }
+    }
+    if (status != STREAM_FINISHED) {
+        return 0;
+    }
+    CX_ASSERT(cx_hash_no_throw(&sha256.header, CX_LAST, NULL, 0, digest, 32));
+    return chunks;
+}
+
+int main(void) {
+    static uint8_t transaction[MAX_TRANSACTION];
+    uint8_t digest[32], expected[32];
+    bool ok = true;
+
+    printf("cx_hash_no_throw calls to stream the reference corpus, chunks of %d then %d bytes\n",
+           FIRST_CHUNK_SIZE,
+           CHUNK_SIZE);
+    printf("%-26s %6s %7s %8s %11s\n", "transaction", "bytes", "chunks", "returns", "hash calls");
+    for (uint32_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); i++) {
+        char path[64];
+        uint32_t length, chunks, calls;
+        FILE *f;
+
+        snprintf(path, sizeof(path), CORPUS_DIRECTORY "%s", CORPUS[i]);
+        f = fopen(path, "rb");
+        if (f == NULL) {
+            printf("Can't open %s\n", path);
+            return 1;
+        }
+        length = fread(transaction, 1, sizeof(transaction), f);
+        fclose(f);
+
+        // Byte by byte, the digest is the reference
+        if (stream_transaction(transaction, length, 1, 1, expected) == 0) {
+            printf("%s: parser failure\n", CORPUS[i]);
+            return 1;
+        }
+
+        reset_hash_counters();
+        chunks = stream_transaction(transaction, length, FIRST_CHUNK_SIZE, CHUNK_SIZE, digest);
+        calls = g_hash_calls;
+        printf("%-26s %6u %7u %8u %11u\n", CORPUS[i], length, chunks, parserReturns, calls);
+
+        if (chunks == 0 || memcmp(digest, expected, sizeof(digest)) != 0) {
+            printf("%s: the digest depends on the chunks\n", CORPUS[i]);
+            ok = false;
+        }
+        // Each digest is updated once when parseTx returns. The transaction digest is
+        // finalized once, the action data checksum once per action.
+        if (calls > 2 * parserReturns + 1 + actions) {
+            printf("%s: more than one hash call per digest when parseTx returns\n", CORPUS[i]);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_utils.h"
+#include "native_mocks.h"
+#include "reference.h"
+
+#define SIGNATURES 20000
+// Candidates per signature: the first one and the retries until it is canonical
+#define CANDIDATES 4
+
+static const uint8_t SECP256K1_N[] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+    0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41};
+
+// An order that rejects about half of the candidates, for the rejection loop
+static const uint8_t SMALL_ORDER[32] = {0x80};
+
+typedef struct cost_t {
+    uint32_t first;
+    uint32_t retries;
+    uint64_t ns;
+} cost_t;
+
+static void random_bytes(uint8_t *out, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        out[i] = test_random();
+    }
+}
+
+/**
+ * Generate the candidates of a signature with both generators, compare them and add
+ * the SHA-256 compressions of each to the costs.
+ */
+static bool check_signature(const uint8_t *q, cost_t *previous, cost_t *current) {
+    uint8_t h1[32], x[32];
+    uint8_t expected[CANDIDATES][32], actual[CANDIDATES][32];
+    uint8_t V[33], K[32];
+    rfc6979_state_t state;
+    uint64_t start;
+    uint32_t i;
+
+    random_bytes(h1, sizeof(h1));
+    random_bytes(x, sizeof(x));
+
+    start = now_ns();
+    for (i = 0; i < CANDIDATES; i++) {
+        reset_hash_counters();
+        reference_rng_rfc6979(expected[i], h1, i == 0 ? x : NULL, sizeof(x), q, 32, V, K);
+        *(i == 0 ? &previous->first : &previous->retries) += g_sha256_compressions;
+    }
+    previous->ns += now_ns() - start;
+
+    start = now_ns();
+    for (i = 0; i < CANDIDATES; i++) {
+        reset_hash_counters();
+        rng_rfc6979(actual[i], h1, i == 0 ? x : NULL, i == 0 ? sizeof(x) : 0, q, 32, &state);
+        *(i == 0 ? &current->first : &current->retries) += g_sha256_compressions;
+    }
+    current->ns += now_ns() - start;
+
+    if (memcmp(expected, actual, sizeof(actual)) != 0) {
+        printf("rng_rfc6979 gives other candidates than before\n");
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    cost_t previous = {0}, current = {0}, unused = {0};
+    uint32_t i;
+
+    for (i = 0; i < SIGNATURES; i++) {
+        if (!check_signature(SECP256K1_N, &previous, &current) ||
+            (i % 8 == 0 && !check_signature(SMALL_ORDER, &unused, &unused))) {
+            return 1;
+        }
+    }
+
+    printf("rng_rfc6979: %u signatures of %u candidates as before\n", SIGNATURES, CANDIDATES);
+    printf("SHA-256 compressions   first candidate   retry   time per signature\n");
+    printf("  previous             %15.1f %7.1f %14.0f ns\n",
+           (double) previous.first / SIGNATURES,
+           (double) previous.retries / (SIGNATURES * (CANDIDATES - 1)),
+           (double) previous.ns / SIGNATURES);
+    printf("  current              %15.1f %7.1f %14.0f ns\n",
+           (double) current.first / SIGNATURES,
+           (double) current.retries / (SIGNATURES * (CANDIDATES - 1)),
+           (double) current.ns / SIGNATURES);
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_utils.h"
+#include "native_mocks.h"
+#include "reference.h"
+
+#define CORPUS_DIRECTORY "ref_corpus/"
+#define MAX_TRANSACTION  16384
+#define ROUNDS           2000
+
+// The tlv buffer of the parser, for headers split across chunks
+#define TLV_BUFFER_SIZE 5
+
+static const char *const CORPUS[] = {
+    "transaction",
+    "transaction_buyram",
+    "transaction_buyrambytes",
+    "transaction_deleteauth",
+    "transaction_linkauth",
+    "transaction_newaccount",
+    "transaction_refund",
+    "transaction_sellram",
+    "transaction_unknown",
+    "transaction_unlinkauth",
+    "transaction_updateauth",
+    "transaction_vote",
+    "transaction_vote_proxy",
+};
+
+#define CORPUS_SIZE (sizeof(CORPUS) / sizeof(CORPUS[0]))
+
+typedef bool (*header_decoder_t)(uint8_t *data,
+                                 uint32_t length,
+                                 uint32_t *fieldLength,
+                                 uint32_t *headerLength);
+
+static uint8_t transactions[CORPUS_SIZE][MAX_TRANSACTION];
+static uint32_t lengths[CORPUS_SIZE];
+// Calls of the TLV decoding function by the last walk
+static uint32_t decodeCalls;
+static volatile uint32_t sink;
+
+/**
+ * Previous header decoding: each byte is copied into the tlv buffer, which is decoded
+ * again after each byte.
+ */
+static bool decode_previous(uint8_t *data,
+                            uint32_t length,
+                            uint32_t *fieldLength,
+                            uint32_t *headerLength) {
+    uint8_t tlvBuffer[TLV_BUFFER_SIZE];
+    uint32_t pos = 0;
+    bool valid;
+
+    while (pos < length) {
+        tlvBuffer[pos] = data[pos];
+        pos++;
+        decodeCalls++;
+        if (reference_tlv_try_decode(tlvBuffer, pos, fieldLength, &valid)) {
+            *headerLength = pos;
+            return true;
+        }
+        if (!valid || pos == sizeof(tlvBuffer)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Current header decoding of a header split across chunks, byte by byte as well.
+ */
+static bool decode_split(uint8_t *data,
+                         uint32_t length,
+                         uint32_t *fieldLength,
+                         uint32_t *headerLength) {
+    uint8_t tlvBuffer[TLV_BUFFER_SIZE];
+    uint32_t pos = 0;
+    bool valid;
+
+    while (pos < length) {
+        tlvBuffer[pos] = data[pos];
+        pos++;
+        decodeCalls++;
+        if (tlvTryDecode(tlvBuffer, pos, fieldLength, headerLength, &valid)) {
+            return true;
+        }
+        if (!valid || pos == sizeof(tlvBuffer)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Current header decoding of a header wholly in the chunk, in place.
+ */
+static bool decode_current(uint8_t *data,
+                           uint32_t length,
+                           uint32_t *fieldLength,
+                           uint32_t *headerLength) {
+    bool valid;
+
+    decodeCalls++;
+    return tlvTryDecode(data, length, fieldLength, headerLength, &valid);
+}
+
+/**
+ * Walk the fields of a transaction, record the size of each field. Return the number
+ * of fields, 0 if a header can't be decoded.
+ */
+static uint32_t walk_fields(header_decoder_t decoder,
+                            uint8_t *transaction,
+                            uint32_t length,
+                            uint32_t *fieldLengths) {
+    uint32_t offset = 0, fields = 0;
+
+    while (offset < length) {
+        uint32_t fieldLength, headerLength;
+        if (!decoder(transaction + offset, length - offset, &fieldLength, &headerLength)) {
+            return 0;
+        }
+        offset += headerLength + fieldLength;
+        if (fieldLengths != NULL) {
+            fieldLengths[fields] = fieldLength;
+        }
+        fields++;
+    }
+    return offset == length ? fields : 0;
+}
+
+static double time_decoder(header_decoder_t decoder, uint32_t *fields, uint32_t *calls) {
+    uint64_t start;
+
+    *fields = 0;
+    decodeCalls = 0;
+    start = now_ns();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+            sink += walk_fields(decoder, transactions[i], lengths[i], NULL);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+        *fields += walk_fields(decoder, transactions[i], lengths[i], NULL);
+    }
+    *calls = decodeCalls / (ROUNDS + 1);
+    return (double) elapsed / (ROUNDS * *fields);
+}
+
+/**
+ * The decoders give the same fields on the corpus, and agree on a header with a length
+ * of 4 bytes, wholly in the chunk or split.
+ */
+static bool check_decoders(void) {
+    static uint32_t previous[MAX_TRANSACTION], current[MAX_TRANSACTION];
+    uint8_t longHeader[] = {0x04, 0x84, 0x00, 0x00, 0x00, 0x01, 0x00};
+    uint32_t fieldLength, headerLength;
+
+    for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+        uint32_t fields = walk_fields(decode_previous, transactions[i], lengths[i], previous);
+        if (fields == 0 ||
+            walk_fields(decode_current, transactions[i], lengths[i], current) != fields ||
+            memcmp(previous, current, fields * sizeof(current[0])) != 0 ||
+            walk_fields(decode_split, transactions[i], lengths[i], current) != fields ||
+            memcmp(previous, current, fields * sizeof(current[0])) != 0) {
+            printf("%s: the fields differ\n", CORPUS[i]);
+            return false;
+        }
+    }
+    if (decode_current(longHeader, sizeof(longHeader), &fieldLength, &headerLength) ||
+        decode_split(longHeader, sizeof(longHeader), &fieldLength, &headerLength) ||
+        decode_previous(longHeader, sizeof(longHeader), &fieldLength, &headerLength)) {
+        printf("A header with a length of 4 bytes is accepted\n");
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    uint32_t fields, calls;
+    double ns;
+
+    for (uint32_t i = 0; i < CORPUS_SIZE; i++) {
+        char path[64];
+        FILE *f;
+
+        snprintf(path, sizeof(path), CORPUS_DIRECTORY "%s", CORPUS[i]);
+        f = fopen(path, "rb");
+        if (f == NULL) {
+            printf("Can't open %s\n", path);
+            return 1;
+        }
+        lengths[i] = fread(transactions[i], 1, sizeof(transactions[i]), f);
+        fclose(f);
+    }
+    if (!check_decoders()) {
+        return 1;
+    }
+
+    printf("TLV headers of the reference corpus\n");
+    printf("%-10s %7s %13s %16s\n", "", "fields", "ns per field", "decode per field");
+    ns = time_decoder(decode_previous, &fields, &calls);
+    printf("%-10s %7u %13.2f %16.2f\n", "previous", fields, ns, (double) calls / fields);
+    ns = time_decoder(decode_current, &fields, &calls);
+    printf("%-10s %7u %13.2f %16.2f\n", "current", fields, ns, (double) calls / fields);
+    return 0;
+}
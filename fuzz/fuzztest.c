@@ -15,11 +15,29 @@ txProcessingContent_t txContent;
 cx_sha256_t sha256;
 cx_sha256_t sha256_arg;
 
+// First byte of a TLV transaction, the tag of the chain id
+#define TLV_TAG 0x04
+
 int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
+    // A TLV transaction starts with its tag, any other first byte selects a packed
+    // transaction made of the next bytes.
+    bool packed = Size > 0 && Data[0] != TLV_TAG;
+    if (packed) {
+        Data++;
+        Size--;
+    }
+
+    // The parser compacts hashed data in place, work on a copy as the device does
+    // with G_io_apdu_buffer.
+    if (Size > sizeof(G_io_apdu_buffer)) {
+        return 0;
+    }
+    memmove(G_io_apdu_buffer, Data, Size);
+
     UX_INIT();
 
-    initTxContext(&txProcessingCtx, &sha256, &sha256_arg, &txContent, 1);
-    uint8_t status = parseTx(&txProcessingCtx, (uint8_t *) Data, Size);
+    initTxContext(&txProcessingCtx, &sha256, &sha256_arg, &txContent, 1, packed, NULL);
+    uint8_t status = parseTx(&txProcessingCtx, G_io_apdu_buffer, Size);
 
     if (Size > 0) {
         do {
@@ -31,7 +49,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
                     return 0;
             }
 
-            status = parseTx(&txProcessingCtx, (uint8_t *) Data, Size);
+            status = parseTx(&txProcessingCtx, G_io_apdu_buffer, Size);
 
         } while (status != STREAM_FINISHED);
     }
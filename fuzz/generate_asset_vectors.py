@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+import sys
+import random
+import struct
+
+from pathlib import Path
+
+REPO_ROOT_DIRECTORY = Path(__file__).parent
+EOS_LIB_DIRECTORY = (REPO_ROOT_DIRECTORY / "../tests/functional/apps").resolve().as_posix()
+sys.path.append(EOS_LIB_DIRECTORY)
+from eos_transaction_builder import encode_asset
+
+SYMBOLS = ['EOS', 'SYS', 'A', 'ABCDEFG']
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+
+def asset_text(amount, precision, symbol):
+    """ Text of an asset as the chain writes it """
+    digits = str(abs(amount)).rjust(precision + 1, '0')
+    if precision:
+        digits = digits[:-precision] + '.' + digits[-precision:]
+    return ('-' if amount < 0 else '') + digits + ' ' + symbol
+
+
+def amounts(precision, rng):
+    yield from [0, 1, -1, 5, -5, 9, 10, 99, 100, -15, INT64_MAX, INT64_MIN, INT64_MIN + 1,
+                10**18, -10**18, 10**precision, 10**precision - 1, -10**precision]
+    for _ in range(40):
+        yield rng.getrandbits(rng.randint(1, 63)) * rng.choice([1, -1])
+
+
+def main():
+    rng = random.Random(1)
+    out_path = REPO_ROOT_DIRECTORY / "asset_vectors.txt"
+    with open(out_path, 'w') as out:
+        out.write("# Assets encoded by encode_asset and their text\n")
+        for precision in range(19):
+            for i, amount in enumerate(amounts(precision, rng)):
+                text = asset_text(amount, precision, SYMBOLS[i % len(SYMBOLS)])
+                data = encode_asset(text)
+                assert struct.unpack('<q', data[:8])[0] == amount, text
+                out.write(f"{data.hex()} {text}\n")
+
+
+if __name__ == "__main__":
+    main()
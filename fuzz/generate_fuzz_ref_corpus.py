@@ -11,8 +11,13 @@ EOS_LIB_DIRECTORY = (REPO_ROOT_DIRECTORY / "../tests/functional/apps").resolve()
 sys.path.append(EOS_LIB_DIRECTORY)
 from eos_transaction_builder import Transaction
 
+# First byte of a packed transaction for the fuzzer, P2 of a packed SIGN command
+PACKED_MODE = b'\x01'
+
 parser = argparse.ArgumentParser()
 parser.add_argument('--file', help="Transaction in JSON format")
+parser.add_argument('--packed', action='store_true',
+                    help="Packed transaction, written to a _packed.bin file")
 args = parser.parse_args()
 
 if args.file is None:
@@ -20,7 +25,15 @@ if args.file is None:
 
 with open(args.file) as f:
     obj = json.load(f)
-signing_digest, message = Transaction().encode(obj)
 
-with open(args.file.replace(".json", ".bin"), 'wb') as out:
+if args.packed:
+    # The fuzzer reads a packed transaction after a first byte other than the TLV tag 0x04
+    signing_digest, message = Transaction().encode_packed(obj)
+    message = PACKED_MODE + message
+    output = args.file.replace(".json", "_packed.bin")
+else:
+    signing_digest, message = Transaction().encode(obj)
+    output = args.file.replace(".json", ".bin")
+
+with open(output, 'wb') as out:
     out.write(message)
@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_stream.h"
+#include "main.h"
+#include "main_mocks.h"
+
+#define CLA      0xD4
+#define INS_SIGN 0x04
+#define P1_FIRST 0x00
+#define P1_MORE  0x80
+
+uint8_t G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+uint32_t g_derivations;
+uint8_t g_last_signing_key[32];
+uint32_t g_signatures;
+static bool reviewPending;
+static uint16_t responseLength;
+
+bolos_err_t os_derive_bip32_with_seed_no_throw(unsigned int derivation_mode,
+                                               cx_curve_t curve,
+                                               const unsigned int *path,
+                                               unsigned int path_len,
+                                               unsigned char raw_privkey[static 64],
+                                               unsigned char *chain_code,
+                                               unsigned char *seed_key,
+                                               unsigned int seed_key_length) {
+    UNUSED(derivation_mode);
+    UNUSED(curve);
+    UNUSED(chain_code);
+    UNUSED(seed_key);
+    UNUSED(seed_key_length);
+
+    // The key of a path is its last index repeated
+    g_derivations++;
+    for (uint32_t i = 0; i < 64; i++) {
+        raw_privkey[i] = path[path_len - 1] >> (8 * (i % 4));
+    }
+    return 0;
+}
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve,
+                                           const uint8_t *rawkey,
+                                           size_t key_len,
+                                           cx_ecfp_private_key_t *pvkey) {
+    pvkey->curve = curve;
+    pvkey->d_len = key_len;
+    memmove(pvkey->d, rawkey, key_len);
+    return CX_OK;
+}
+
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve,
+                                        cx_ecfp_public_key_t *pubkey,
+                                        cx_ecfp_private_key_t *privkey,
+                                        bool keepprivate) {
+    UNUSED(privkey);
+    UNUSED(keepprivate);
+    pubkey->curve = curve;
+    pubkey->W_len = 65;
+    memset(pubkey->W, 0x04, sizeof(pubkey->W));
+    return CX_OK;
+}
+
+cx_err_t cx_ecdsa_sign_rs_no_throw(const cx_ecfp_private_key_t *key,
+                                   uint32_t mode,
+                                   cx_md_t hashID,
+                                   const uint8_t *hash,
+                                   size_t hash_len,
+                                   size_t rs_len,
+                                   uint8_t *sig_r,
+                                   uint8_t *sig_s,
+                                   uint32_t *info) {
+    UNUSED(mode);
+    UNUSED(hashID);
+    UNUSED(hash_len);
+
+    // Not a signature, but r and s vary with the nonce provided in r so that some
+    // candidates are canonical, and the digest is s xored with r reversed
+    memmove(g_last_signing_key, key->d, sizeof(g_last_signing_key));
+    g_signatures++;
+    for (size_t i = 0; i < rs_len; i++) {
+        sig_s[i] = sig_r[rs_len - 1 - i] ^ hash[i];
+    }
+    *info = 0;
+    return CX_OK;
+}
+
+uint32_t cx_crc32(const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    uint32_t crc = 0xFFFFFFFF;
+
+    while (len--) {
+        crc ^= *p++;
+        for (uint32_t i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len) {
+    UNUSED(channel_and_flags);
+    responseLength = tx_len;
+    return 0;
+}
+
+void os_sched_exit(bolos_task_status_t exit_code) {
+    exit(exit_code);
+}
+
+void config_init(void) {
+}
+
+bool is_data_allowed(void) {
+    return true;
+}
+
+void ui_idle(void) {
+}
+
+void ui_display_public_key_flow(void) {
+}
+
+void ui_display_public_key_done(bool validated) {
+    UNUSED(validated);
+}
+
+void ui_display_single_action_sign_flow(void) {
+    reviewPending = true;
+}
+
+void ui_display_multiple_action_sign_flow(void) {
+    reviewPending = true;
+}
+
+void ui_display_action_sign_done(parserStatus_e status, bool validated) {
+    UNUSED(status);
+    UNUSED(validated);
+}
+
+uint16_t exchange_approved(uint32_t *dataLength) {
+    volatile unsigned int flags = 0, tx = 0;
+    uint16_t sw;
+
+    reviewPending = false;
+    sw = handleApdu(&flags, &tx);
+    if ((flags & IO_ASYNCH_REPLY) == 0) {
+        *dataLength = tx;
+        return sw;
+    }
+    // The answer is sent by the last approval
+    while (reviewPending) {
+        reviewPending = false;
+        user_action_sign_flow_ok();
+    }
+    *dataLength = responseLength - 2;
+    return (G_io_apdu_buffer[responseLength - 2] << 8) | G_io_apdu_buffer[responseLength - 1];
+}
+
+uint16_t exchange_sign(const uint8_t *payload, uint32_t length, uint8_t p2, uint32_t *dataLength) {
+    uint16_t sw = 0x9000;
+
+    for (uint32_t offset = 0; offset < length && sw == 0x9000; offset += 255) {
+        uint32_t chunkLength = length - offset < 255 ? length - offset : 255;
+
+        G_io_apdu_buffer[0] = CLA;
+        G_io_apdu_buffer[1] = INS_SIGN;
+        G_io_apdu_buffer[2] = offset == 0 ? P1_FIRST : P1_MORE;
+        G_io_apdu_buffer[3] = p2;
+        G_io_apdu_buffer[4] = chunkLength;
+        memmove(G_io_apdu_buffer + 5, payload + offset, chunkLength);
+        sw = exchange_approved(dataLength);
+    }
+    return sw;
+}
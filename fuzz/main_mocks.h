@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Mocks of the SDK and of the UI used by main.c, for the native checks of its commands.
+ * The key of a path is its last index repeated, and a signature is not one but gives
+ * back the digest it is made over.
+ */
+
+// Key derivations
+extern uint32_t g_derivations;
+// Private key of the last signature
+extern uint8_t g_last_signing_key[32];
+// Signatures made, canonical or not
+extern uint32_t g_signatures;
+
+// Defined in main.c without a declaration in its header
+uint32_t handleApdu(volatile unsigned int *flags, volatile unsigned int *tx);
+
+/**
+ * Process the command in G_io_apdu_buffer, approving each review it starts. Return the
+ * status word, the response data is at the start of G_io_apdu_buffer.
+ */
+uint16_t exchange_approved(uint32_t *dataLength);
+
+/**
+ * Send the payload in SIGN commands of 255 bytes at most, approving each review. Return
+ * the status word of the last command sent, the first failed one stops the sending.
+ */
+uint16_t exchange_sign(const uint8_t *payload, uint32_t length, uint8_t p2, uint32_t *dataLength);
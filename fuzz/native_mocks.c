@@ -0,0 +1,234 @@
+#include <string.h>
+#include <time.h>
+
+#include "os.h"
+#include "cx.h"
+#include "cx_hash.h"
+#include "lcx_sha256.h"
+#include "lcx_ripemd160.h"
+
+#include "native_mocks.h"
+
+uint32_t g_hash_calls;
+uint32_t g_sha256_compressions;
+
+void reset_hash_counters(void) {
+    g_hash_calls = 0;
+    g_sha256_compressions = 0;
+}
+
+uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+size_t strlcat(char *dst, const char *src, size_t size) {
+    size_t ld = strnlen(dst, size);
+    if (ld == size) {
+        return ld + strlen(src);
+    }
+    return ld + strlcpy(dst + ld, src, size - ld);
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t ls = strlen(src);
+    if (size != 0) {
+        size_t n = ls < size - 1 ? ls : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return ls;
+}
+
+void assert_exit(bool confirm) {
+    UNUSED(confirm);
+    fprintf(stderr, "LEDGER_ASSERT failed\n");
+    exit(-1);
+}
+
+try_context_t *current_context = NULL;
+try_context_t *try_context_get(void) {
+    return current_context;
+}
+
+try_context_t *try_context_set(try_context_t *ctx) {
+    try_context_t *previous_ctx = current_context;
+    current_context = ctx;
+    return previous_ctx;
+}
+
+void os_longjmp(unsigned int exception) {
+    if (current_context == NULL) {
+        fprintf(stderr, "Exception 0x%x\n", exception);
+        exit(-1);
+    }
+    longjmp(current_context->jmp_buf, exception);
+}
+
+void *pic(void *linked_addr) {
+    return linked_addr;
+}
+
+static const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+static const uint32_t hzero[] = {0x6a09e667,
+                                 0xbb67ae85,
+                                 0x3c6ef372,
+                                 0xa54ff53a,
+                                 0x510e527f,
+                                 0x9b05688c,
+                                 0x1f83d9ab,
+                                 0x5be0cd19};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_compress(cx_sha256_t *ctx, const uint8_t *block) {
+    uint32_t w[64], s[8], acc[8];
+    uint32_t i;
+
+    memcpy(acc, ctx->acc, sizeof(acc));
+    for (i = 0; i < 16; i++) {
+        w[i] = (block[4 * i] << 24) | (block[4 * i + 1] << 16) | (block[4 * i + 2] << 8) |
+               block[4 * i + 3];
+    }
+    for (i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    memcpy(s, acc, sizeof(s));
+    for (i = 0; i < 64; i++) {
+        uint32_t t1 = s[7] + (ROTR(s[4], 6) ^ ROTR(s[4], 11) ^ ROTR(s[4], 25)) +
+                      ((s[4] & s[5]) ^ (~s[4] & s[6])) + K256[i] + w[i];
+        uint32_t t2 = (ROTR(s[0], 2) ^ ROTR(s[0], 13) ^ ROTR(s[0], 22)) +
+                      ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        memmove(s + 1, s, 7 * sizeof(uint32_t));
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+    for (i = 0; i < 8; i++) {
+        acc[i] += s[i];
+    }
+    memcpy(ctx->acc, acc, sizeof(acc));
+    ctx->header.counter++;
+    g_sha256_compressions++;
+}
+
+static void sha256_update(cx_sha256_t *ctx, const uint8_t *in, size_t len) {
+    while (len > 0) {
+        size_t n = sizeof(ctx->block) - ctx->blen;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->blen, in, n);
+        ctx->blen += n;
+        in += n;
+        len -= n;
+        if (ctx->blen == sizeof(ctx->block)) {
+            sha256_compress(ctx, ctx->block);
+            ctx->blen = 0;
+        }
+    }
+}
+
+static void sha256_final(cx_sha256_t *ctx, uint8_t *digest) {
+    uint64_t bits = ((uint64_t) ctx->header.counter * 64 + ctx->blen) * 8;
+    uint8_t pad[64 + 8] = {0x80};
+    size_t padLength = (ctx->blen < 56 ? 56 : 120) - ctx->blen;
+    uint32_t acc[8];
+    uint32_t i;
+
+    for (i = 0; i < 8; i++) {
+        pad[padLength + i] = bits >> (56 - 8 * i);
+    }
+    sha256_update(ctx, pad, padLength + 8);
+    memcpy(acc, ctx->acc, sizeof(acc));
+    for (i = 0; i < 32; i++) {
+        digest[i] = acc[i / 4] >> (24 - 8 * (i % 4));
+    }
+}
+
+cx_err_t fake_update(cx_hash_t *ctx, const uint8_t *data, size_t len) {
+    UNUSED(ctx);
+    UNUSED(data);
+    UNUSED(len);
+    return CX_OK;
+}
+cx_err_t fake_final(cx_hash_t *ctx, uint8_t *digest) {
+    UNUSED(ctx);
+    UNUSED(digest);
+    return CX_OK;
+}
+
+const cx_hash_info_t cx_sha256_info = {
+    CX_SHA256,
+    CX_SHA256_SIZE,
+    SHA256_BLOCK_SIZE,
+    (cx_err_t(*)(cx_hash_t * ctx)) cx_sha256_init_no_throw,
+    (cx_err_t(*)(cx_hash_t * ctx, const uint8_t *data, size_t len)) fake_update,
+    (cx_err_t(*)(cx_hash_t * ctx, uint8_t *digest)) fake_final,
+    NULL,
+    NULL};
+
+#define RIPEMD_BLOCK_SIZE 64
+
+const cx_hash_info_t cx_ripemd160_info = {
+    CX_RIPEMD160,
+    CX_RIPEMD160_SIZE,
+    RIPEMD_BLOCK_SIZE,
+    (cx_err_t(*)(cx_hash_t * ctx)) cx_ripemd160_init_no_throw,
+    (cx_err_t(*)(cx_hash_t * ctx, const uint8_t *data, size_t len)) fake_update,
+    (cx_err_t(*)(cx_hash_t * ctx, uint8_t *digest)) fake_final,
+    NULL,
+    NULL};
+
+cx_err_t cx_sha256_init_no_throw(cx_sha256_t *hash) {
+    memset(hash, 0, sizeof(cx_sha256_t));
+    hash->header.info = &cx_sha256_info;
+    memmove(hash->acc, hzero, sizeof(hzero));
+    return CX_OK;
+}
+
+cx_err_t cx_ripemd160_init_no_throw(cx_ripemd160_t *hash) {
+    memset(hash, 0, sizeof(cx_ripemd160_t));
+    hash->header.info = &cx_ripemd160_info;
+    return CX_OK;
+}
+
+size_t cx_hash_get_size(const cx_hash_t *ctx) {
+    return ctx->info->output_size;
+}
+
+cx_err_t cx_hash_no_throw(cx_hash_t *hash,
+                          uint32_t mode,
+                          const uint8_t *in,
+                          size_t len,
+                          uint8_t *out,
+                          size_t out_len) {
+    size_t size = cx_hash_get_size(hash);
+
+    g_hash_calls++;
+    if ((mode & CX_LAST) != 0 && (out == NULL || out_len < size)) {
+        return CX_INVALID_PARAMETER;
+    }
+    if (hash->info == &cx_sha256_info) {
+        sha256_update((cx_sha256_t *) hash, in, len);
+        if ((mode & CX_LAST) != 0) {
+            sha256_final((cx_sha256_t *) hash, out);
+        }
+    } else if ((mode & CX_LAST) != 0) {
+        memset(out, 0, size);
+    }
+    return CX_OK;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Mocks of the SDK for the native checks. SHA-256 is computed for real so that
+ * digests and nonces can be compared, RIPEMD-160 digests are all zeros.
+ */
+
+// Calls of cx_hash_no_throw, whatever the hash
+extern uint32_t g_hash_calls;
+// SHA-256 compressions, the cost of a digest on the device
+extern uint32_t g_sha256_compressions;
+
+void reset_hash_counters(void);
+
+/**
+ * Nanoseconds elapsed since an arbitrary origin, for the benchmarks.
+ */
+uint64_t now_ns(void);
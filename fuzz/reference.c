@@ -0,0 +1,296 @@
+#include <string.h>
+
+#include "cx.h"
+
+#include "reference.h"
+
+static const char ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+// b58enc before it converted the number in limbs of five digits
+bool reference_b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz) {
+    int carry;
+    uint32_t i, j, high, zcount = 0;
+    uint32_t size;
+
+    while (zcount < binsz && !bin[zcount]) ++zcount;
+
+    size = (binsz - zcount) * 138 / 100 + 1;
+    uint8_t buf[size];
+    memset(buf, 0, size);
+
+    for (i = zcount, high = size - 1; i < binsz; ++i, high = j) {
+        for (carry = bin[i], j = size - 1; (j > high) || carry; --j) {
+            carry += 256 * buf[j];
+            buf[j] = carry % 58;
+            carry /= 58;
+            if (!j) {
+                // Otherwise j wraps to maxint which is > high
+                break;
+            }
+        }
+    }
+
+    for (j = 0; j < size && !buf[j]; ++j)
+        ;
+
+    if (*b58sz <= zcount + size - j) {
+        *b58sz = zcount + size - j + 1;
+        return false;
+    }
+
+    if (zcount) memset(b58, '1', zcount);
+    for (i = zcount; j < size; ++i, ++j) b58[i] = ALPHABET[buf[j]];
+    b58[i] = '\0';
+    *b58sz = i + 1;
+
+    return true;
+}
+
+// Defined in eos_types.c without a declaration in its header
+uint64_t symbol_precision(symbol_t sym);
+uint8_t symbol_to_string(symbol_t sym, char *out, uint32_t size);
+
+uint32_t g_reference_divisions;
+
+static int64_t div64(int64_t a, int64_t b) {
+    g_reference_divisions++;
+    return a / b;
+}
+
+static int64_t mod64(int64_t a, int64_t b) {
+    g_reference_divisions++;
+    return a % b;
+}
+
+static char const digit[] = "0123456789";
+
+// i64toa before fixed_point_to_string, INT64_MIN overflows
+char *reference_i64toa(int64_t i, char b[]) {
+    char *p = b;
+    if (i < 0) {
+        *p++ = '-';
+        i *= -1;
+    }
+    int64_t shifter = i;
+    do {  // Move to where representation ends
+        ++p;
+        shifter = div64(shifter, 10);
+    } while (shifter);
+    *p = '\0';
+    do {  // Move back, inserting digits as u go
+        *--p = digit[mod64(i, 10)];
+        i = div64(i, 10);
+    } while (i);
+    return b;
+}
+
+// asset_to_string before fixed_point_to_string. It writes "5. SYS" at precision 0 and
+// the fraction of a negative amount is wrong.
+uint8_t reference_asset_to_string(asset_t *asset, char *out, uint32_t size) {
+    (void) size;
+
+    int64_t p = (int64_t) symbol_precision(asset->symbol);
+    int64_t p10 = 1;
+    while (p > 0) {
+        p10 *= 10;
+        --p;
+    }
+
+    p = (int64_t) symbol_precision(asset->symbol);
+
+    char fraction[p + 1];
+    fraction[p] = 0;
+    int64_t change = mod64(asset->amount, p10);
+
+    for (int64_t i = p - 1; i >= 0; --i) {
+        fraction[i] = mod64(change, 10) + '0';
+        change = div64(change, 10);
+    }
+    char symbol[9];
+    memset(symbol, 0, sizeof(symbol));
+    symbol_to_string(asset->symbol, symbol, 8);
+
+    char tmp[64];
+    memset(tmp, 0, sizeof(tmp));
+    reference_i64toa(div64(asset->amount, p10), tmp);
+    uint32_t assetTextLength = strlen(tmp);
+    tmp[assetTextLength++] = '.';
+    memmove(tmp + assetTextLength, fraction, strlen(fraction));
+    assetTextLength = strlen(tmp);
+    tmp[assetTextLength++] = ' ';
+    memmove(tmp + assetTextLength, symbol, strlen(symbol));
+    assetTextLength = strlen(tmp);
+
+    memmove(out, tmp, assetTextLength);
+
+    return assetTextLength;
+}
+
+/**
+ * HMAC-SHA256 as computed by cx_hmac of the SDK: the key block is hashed again by each
+ * HMAC, in the inner and in the outer digest.
+ */
+typedef struct reference_hmac_t {
+    cx_sha256_t sha;
+    uint8_t key[32];
+} reference_hmac_t;
+
+static void hmac_absorb_key(reference_hmac_t *hmac, uint8_t pad) {
+    uint8_t block[64];
+
+    memset(block, 0, sizeof(block));
+    memmove(block, hmac->key, sizeof(hmac->key));
+    for (uint32_t i = 0; i < sizeof(block); i++) {
+        block[i] ^= pad;
+    }
+    CX_ASSERT(cx_sha256_init_no_throw(&hmac->sha));
+    CX_ASSERT(cx_hash_no_throw(&hmac->sha.header, 0, block, sizeof(block), NULL, 0));
+}
+
+static void hmac_init(reference_hmac_t *hmac, const uint8_t *key) {
+    memmove(hmac->key, key, sizeof(hmac->key));
+    hmac_absorb_key(hmac, 0x36);
+}
+
+static void hmac_update(reference_hmac_t *hmac, const uint8_t *in, uint32_t len) {
+    CX_ASSERT(cx_hash_no_throw(&hmac->sha.header, 0, in, len, NULL, 0));
+}
+
+static void hmac_final(reference_hmac_t *hmac, const uint8_t *in, uint32_t len, uint8_t *mac) {
+    uint8_t digest[32];
+
+    CX_ASSERT(cx_hash_no_throw(&hmac->sha.header, CX_LAST, in, len, digest, sizeof(digest)));
+    hmac_absorb_key(hmac, 0x5c);
+    CX_ASSERT(cx_hash_no_throw(&hmac->sha.header, CX_LAST, digest, sizeof(digest), mac, 32));
+}
+
+void reference_rng_rfc6979(unsigned char *rnd,
+                           const unsigned char *h1,
+                           const unsigned char *x,
+                           unsigned int x_len,
+                           const unsigned char *q,
+                           unsigned int q_len,
+                           unsigned char *V,
+                           unsigned char *K) {
+    unsigned int h_len, offset, found, i;
+    reference_hmac_t hmac;
+
+    h_len = 32;
+    // a. h1 as input
+
+    // loop for a candidate
+    found = 0;
+    while (!found) {
+        if (x) {
+            // b.  Set:          V = 0x01 0x01 0x01 ... 0x01
+            memset(V, 0x01, h_len);
+            // c. Set: K = 0x00 0x00 0x00 ... 0x00
+            memset(K, 0x00, h_len);
+            // d.  Set: K = HMAC_K(V || 0x00 || int2octets(x) || bits2octets(h1))
+            V[h_len] = 0;
+            hmac_init(&hmac, K);
+            hmac_update(&hmac, V, h_len + 1);
+            hmac_update(&hmac, x, x_len);
+            hmac_final(&hmac, h1, h_len, K);
+            // e.  Set: V = HMAC_K(V)
+            hmac_init(&hmac, K);
+            hmac_final(&hmac, V, h_len, V);
+            // f.  Set:  K = HMAC_K(V || 0x01 || int2octets(x) || bits2octets(h1))
+            V[h_len] = 1;
+            hmac_init(&hmac, K);
+            hmac_update(&hmac, V, h_len + 1);
+            hmac_update(&hmac, x, x_len);
+            hmac_final(&hmac, h1, h_len, K);
+            // g. Set: V = HMAC_K(V) --
+            hmac_init(&hmac, K);
+            hmac_final(&hmac, V, h_len, V);
+            // initial setup only once
+            x = NULL;
+        } else {
+            // h.3  K = HMAC_K(V || 0x00)
+            V[h_len] = 0;
+            hmac_init(&hmac, K);
+            hmac_final(&hmac, V, h_len + 1, K);
+            // h.3 V = HMAC_K(V)
+            hmac_init(&hmac, K);
+            hmac_final(&hmac, V, h_len, V);
+        }
+
+        // generate candidate
+        x_len = q_len;
+        offset = 0;
+        while (x_len) {
+            if (x_len < h_len) {
+                h_len = x_len;
+            }
+            hmac_init(&hmac, K);
+            hmac_final(&hmac, V, h_len, V);
+            memmove(rnd + offset, V, h_len);
+            x_len -= h_len;
+        }
+
+        // h.3 Check T is < n
+        for (i = 0; i < q_len; i++) {
+            if (V[i] < q[i]) {
+                found = 1;
+                break;
+            }
+        }
+    }
+}
+
+bool reference_tlv_try_decode(uint8_t *buffer,
+                              uint32_t bufferLength,
+                              uint32_t *fieldLenght,
+                              bool *valid) {
+    // Only OctetString tags
+    if ((*buffer & 0x1f) != 0x04) {
+        *valid = false;
+        return false;
+    }
+
+    if (bufferLength < 2) {
+        *valid = true;
+        return false;
+    }
+    bufferLength--;
+    buffer++;
+    // Read length
+    uint32_t length;
+    uint8_t byte = *buffer;
+    if (byte & 0x80) {
+        uint8_t i;
+        uint8_t count = byte & 0x7f;
+        if (count > 4) {
+            *valid = false;
+            return false;
+        }
+
+        if (count >= bufferLength) {
+            *valid = true;
+            return false;
+        }
+        buffer++;
+        bufferLength--;
+
+        length = 0;
+        for (i = 0; i < count; ++i) {
+            length = (length << 8) | *(buffer + i);
+        }
+    } else {
+        length = byte;
+    }
+    *fieldLenght = length;
+    *valid = true;
+
+    return true;
+}
+
+static uint64_t randomState = 88172645463325252ull;
+
+uint32_t test_random(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return (uint32_t) randomState;
+}
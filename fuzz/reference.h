@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "eos_types.h"
+
+/**
+ * Implementations replaced in the app, kept to check that the new ones give the same
+ * results and to compare their cost.
+ */
+
+bool reference_b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz);
+
+// 64-bit divisions and remainders of the previous formatters, each one is a call to the
+// software division routine on the device
+extern uint32_t g_reference_divisions;
+
+uint8_t reference_asset_to_string(asset_t *asset, char *out, uint32_t size);
+char *reference_i64toa(int64_t i, char b[]);
+
+// rng_rfc6979 before it kept the HMAC key schedule, V has a 33rd byte for the separator
+void reference_rng_rfc6979(unsigned char *rnd,
+                           const unsigned char *h1,
+                           const unsigned char *x,
+                           unsigned int x_len,
+                           const unsigned char *q,
+                           unsigned int q_len,
+                           unsigned char *V,
+                           unsigned char *K);
+
+// tlvTryDecode before it reported the header length, called after each header byte
+// buffered
+bool reference_tlv_try_decode(uint8_t *buffer,
+                              uint32_t bufferLength,
+                              uint32_t *fieldLenght,
+                              bool *valid);
+
+/**
+ * Deterministic pseudo random numbers for the checks (xorshift64).
+ */
+uint32_t test_random(void);
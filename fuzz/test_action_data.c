@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_parse.h"
+#include "eos_stream.h"
+#include "native_mocks.h"
+
+#define CORPUS_DIRECTORY "ref_corpus/"
+// The first SIGN chunk also holds the signing path
+#define FIRST_CHUNK_SIZE 242
+#define CHUNK_SIZE       255
+#define MAX_TRANSACTION  4096
+
+static txProcessingContext_t txProcessingCtx;
+static txProcessingContent_t txContent;
+static cx_sha256_t sha256;
+static cx_sha256_t dataSha256;
+
+// Memo of transaction_long_memo, 200 bytes
+#define LONG_MEMO_PART "Long memo of 200 bytes, cut on the screen of the device. "
+
+/**
+ * Stream a corpus transaction in SIGN chunks, approving every action. The last argument
+ * of the last action is left in txContent. Return the status of the parser.
+ */
+static parserStatus_e stream_transaction(const char *name) {
+    static uint8_t transaction[MAX_TRANSACTION];
+    uint8_t buffer[CHUNK_SIZE];
+    parserStatus_e status = STREAM_PROCESSING;
+    uint32_t offset = 0, length;
+    char path[64];
+    FILE *f;
+
+    snprintf(path, sizeof(path), CORPUS_DIRECTORY "%s", name);
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("Can't open %s\n", path);
+        return STREAM_FAULT;
+    }
+    length = fread(transaction, 1, sizeof(transaction), f);
+    fclose(f);
+
+    initTxContext(&txProcessingCtx, &sha256, &dataSha256, &txContent, 1, false, NULL);
+    while (offset < length && status != STREAM_FINISHED) {
+        uint32_t size = offset == 0 ? FIRST_CHUNK_SIZE : CHUNK_SIZE;
+        if (size > length - offset) {
+            size = length - offset;
+        }
+        // The parser compacts the hashed data in place, as in G_io_apdu_buffer
+        memmove(buffer, transaction + offset, size);
+        offset += size;
+        status = parseTx(&txProcessingCtx, buffer, size);
+        while (status == STREAM_ACTION_READY || status == STREAM_CONFIRM_PROCESSING) {
+            for (uint8_t i = 0; i < txContent.argumentCount; i++) {
+                printArgument(i, &txProcessingCtx);
+            }
+            status = parseTx(&txProcessingCtx, NULL, 0);
+        }
+        if (status == STREAM_FAULT) {
+            break;
+        }
+    }
+    return status;
+}
+
+/**
+ * A memo longer than the display is cut with an ellipsis.
+ */
+static bool check_long_memo(void) {
+    char expected[sizeof(txContent.arg.data)];
+
+    if (stream_transaction("transaction_long_memo") != STREAM_FINISHED) {
+        printf("transaction_long_memo: parser failure\n");
+        return false;
+    }
+    snprintf(expected,
+             sizeof(expected) - 3,
+             "%s%s%s",
+             LONG_MEMO_PART,
+             LONG_MEMO_PART,
+             LONG_MEMO_PART);
+    strlcat(expected, "...", sizeof(expected));
+    printf("%s: %s\n", txContent.arg.label, txContent.arg.data);
+    if (strcmp(txContent.arg.label, "Memo") != 0 || strcmp(txContent.arg.data, expected) != 0) {
+        printf("Expected Memo: %s\n", expected);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * The displayed fields of the updateauth action do not fit in the argument store: the
+ * parser fails.
+ */
+static bool check_store_full(void) {
+    parserStatus_e status = stream_transaction("transaction_updateauth_store_full");
+
+    printf("transaction_updateauth_store_full: %s\n",
+           status == STREAM_FAULT ? "parser failure" : "parsed");
+    return status == STREAM_FAULT;
+}
+
+int main(void) {
+    return check_long_memo() && check_store_full() ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_types.h"
+#include "eos_utils.h"
+#include "reference.h"
+
+#define ASSET_VECTORS   "asset_vectors.txt"
+#define RANDOM_ASSETS   200000
+#define RANDOM_INTEGERS 1000000
+
+typedef struct asset_case_t {
+    int64_t amount;
+    uint8_t precision;
+    const char *expected;
+} asset_case_t;
+
+static const asset_case_t ASSET_CASES[] = {
+    // Precision 0 has no point, the previous formatter wrote "5. EOS"
+    {5, 0, "5 EOS"},
+    {0, 0, "0 EOS"},
+    {-5, 0, "-5 EOS"},
+    // The previous formatter wrote "0.000/ EOS"
+    {-1, 4, "-0.0001 EOS"},
+    {-10000, 4, "-1.0000 EOS"},
+    {-123456, 4, "-12.3456 EOS"},
+    {INT64_MIN, 4, "-922337203685477.5808 EOS"},
+    {INT64_MIN, 0, "-9223372036854775808 EOS"},
+    {INT64_MIN, 18, "-9.223372036854775808 EOS"},
+    {INT64_MAX, 18, "9.223372036854775807 EOS"},
+    {1, 18, "0.000000000000000001 EOS"},
+    {1000000000000000000, 18, "1.000000000000000000 EOS"},
+};
+
+static symbol_t symbol_of(const char *name, uint8_t precision) {
+    symbol_t symbol = precision;
+    for (uint32_t i = 0; name[i] != '\0'; i++) {
+        symbol |= (symbol_t) (uint8_t) name[i] << (8 * (i + 1));
+    }
+    return symbol;
+}
+
+static bool check_asset(asset_t *asset, const char *expected) {
+    char text[32];
+    uint8_t length = asset_to_string(asset, text, sizeof(text));
+
+    if (length != strlen(expected) || memcmp(text, expected, length) != 0) {
+        printf("asset_to_string(%" PRId64 ", precision %u): \"%.*s\", expected \"%s\"\n",
+               asset->amount,
+               (unsigned) (asset->symbol & 0xff),
+               length,
+               text,
+               expected);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t check_cases(void) {
+    for (uint32_t i = 0; i < sizeof(ASSET_CASES) / sizeof(ASSET_CASES[0]); i++) {
+        asset_t asset = {ASSET_CASES[i].amount, symbol_of("EOS", ASSET_CASES[i].precision)};
+        if (!check_asset(&asset, ASSET_CASES[i].expected)) {
+            return 0;
+        }
+    }
+    return sizeof(ASSET_CASES) / sizeof(ASSET_CASES[0]);
+}
+
+/**
+ * Round trips of the text of an asset: encoded by encode_asset of the functional tests,
+ * then written back by asset_to_string.
+ */
+static uint32_t check_vectors(void) {
+    char line[128];
+    uint32_t count = 0;
+    FILE *f = fopen(ASSET_VECTORS, "r");
+
+    if (f == NULL) {
+        printf("Can't open %s\n", ASSET_VECTORS);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        uint8_t data[16];
+        asset_t asset;
+        char *text = line + 2 * sizeof(data) + 1;
+
+        if (line[0] == '#') {
+            continue;
+        }
+        line[strcspn(line, "\n")] = '\0';
+        for (uint32_t i = 0; i < sizeof(data); i++) {
+            unsigned int byte;
+            sscanf(line + 2 * i, "%2x", &byte);
+            data[i] = byte;
+        }
+        // Little endian, as packed in transactions
+        asset.amount = 0;
+        asset.symbol = 0;
+        for (uint32_t i = 0; i < 8; i++) {
+            asset.amount |= (int64_t) ((uint64_t) data[i] << (8 * i));
+            asset.symbol |= (symbol_t) data[8 + i] << (8 * i);
+        }
+        if (!check_asset(&asset, text)) {
+            fclose(f);
+            return 0;
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/**
+ * The previous formatter is right for nonnegative amounts with decimals.
+ */
+static uint32_t check_previous_formatter(void) {
+    for (uint32_t i = 0; i < RANDOM_ASSETS; i++) {
+        uint64_t bits = ((uint64_t) test_random() << 32) | test_random();
+        asset_t asset = {(int64_t) (bits >> (1 + test_random() % 63)),
+                         symbol_of("EOS", 1 + test_random() % 18)};
+        char expected[64];
+        uint8_t length = reference_asset_to_string(&asset, expected, sizeof(expected));
+
+        expected[length] = '\0';
+        if (!check_asset(&asset, expected)) {
+            return 0;
+        }
+    }
+    return RANDOM_ASSETS;
+}
+
+static bool check_integer(uint64_t value) {
+    char expected[24], actual[24];
+
+    snprintf(expected, sizeof(expected), "%" PRIu64, value);
+    ui64toa(value, actual);
+    if (strcmp(expected, actual) != 0) {
+        printf("ui64toa(%s): %s\n", expected, actual);
+        return false;
+    }
+    snprintf(expected, sizeof(expected), "%" PRId64, (int64_t) value);
+    i64toa((int64_t) value, actual);
+    if (strcmp(expected, actual) != 0) {
+        printf("i64toa(%s): %s\n", expected, actual);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t check_integers(void) {
+    static const uint64_t EDGES[] = {0,
+                                     1,
+                                     9,
+                                     10,
+                                     UINT32_MAX,
+                                     (uint64_t) UINT32_MAX + 1,
+                                     INT64_MAX,
+                                     (uint64_t) INT64_MIN,
+                                     10000000000000000000ull,
+                                     UINT64_MAX};
+    uint32_t i;
+
+    for (i = 0; i < sizeof(EDGES) / sizeof(EDGES[0]); i++) {
+        if (!check_integer(EDGES[i]) || !check_integer(EDGES[i] - 1)) {
+            return 0;
+        }
+    }
+    for (i = 0; i < RANDOM_INTEGERS; i++) {
+        uint64_t bits = ((uint64_t) test_random() << 32) | test_random();
+        if (!check_integer(bits >> (test_random() % 64))) {
+            return 0;
+        }
+    }
+    return 2 * (sizeof(EDGES) / sizeof(EDGES[0])) + RANDOM_INTEGERS;
+}
+
+int main(void) {
+    uint32_t cases, vectors, previous, integers;
+
+    if ((cases = check_cases()) == 0 || (vectors = check_vectors()) == 0 ||
+        (previous = check_previous_formatter()) == 0 || (integers = check_integers()) == 0) {
+        return 1;
+    }
+    printf("asset_to_string: %u cases, %u round trips through encode_asset, %u assets as before\n",
+           cases,
+           vectors,
+           previous);
+    printf("i64toa and ui64toa: %u integers as printf\n", integers);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "eos_utils.h"
+#include "reference.h"
+
+#define MAX_INPUT_SIZE 64
+#define RANDOM_INPUTS  20000
+
+static uint32_t checks;
+
+/**
+ * Encode with both implementations into an output buffer of the given size and
+ * compare the results, the sizes they report and the output.
+ */
+static bool check(uint8_t *bin, uint32_t binsz, uint32_t outsz) {
+    char expected[2 * MAX_INPUT_SIZE], actual[2 * MAX_INPUT_SIZE];
+    uint32_t expectedSize = outsz, actualSize = outsz;
+    bool expectedResult, actualResult;
+
+    memset(expected, 0x55, sizeof(expected));
+    memset(actual, 0x55, sizeof(actual));
+    expectedResult = reference_b58enc(bin, binsz, expected, &expectedSize);
+    actualResult = b58enc(bin, binsz, actual, &actualSize);
+    checks++;
+    if (expectedResult != actualResult || expectedSize != actualSize ||
+        memcmp(expected, actual, sizeof(actual)) != 0) {
+        printf("b58enc mismatch, %u bytes into %u:", binsz, outsz);
+        for (uint32_t i = 0; i < binsz; i++) {
+            printf(" %02x", bin[i]);
+        }
+        printf("\n");
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    uint8_t bin[MAX_INPUT_SIZE];
+    uint32_t length, i, v;
+
+    // Every input of one and two bytes
+    for (v = 0; v < 0x10000; v++) {
+        bin[0] = v >> 8;
+        bin[1] = v;
+        if (!check(bin + 1, 1, sizeof(bin)) || !check(bin, 2, sizeof(bin))) {
+            return 1;
+        }
+    }
+
+    // Random inputs up to the largest size, with leading zeros, runs of 0xff and
+    // output buffers too short
+    for (length = 0; length <= MAX_INPUT_SIZE; length++) {
+        for (v = 0; v < RANDOM_INPUTS; v++) {
+            uint32_t zeros = length != 0 && v % 4 == 0 ? test_random() % (length + 1) : 0;
+            for (i = 0; i < length; i++) {
+                bin[i] = i < zeros ? 0 : (v % 7 == 0 ? 0xff : (uint8_t) test_random());
+            }
+            if (!check(bin, length, v % 3 == 0 ? test_random() % 100 : 2 * MAX_INPUT_SIZE)) {
+                return 1;
+            }
+        }
+    }
+
+    printf("b58enc: %u inputs encoded as before\n", checks);
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_stream.h"
+#include "main.h"
+#include "main_mocks.h"
+
+#define CORPUS_DIRECTORY "ref_corpus/"
+
+#define CLA                    0xD4
+#define INS_GET_LAST_SIGNATURE 0x0A
+#define P2_BATCH               0x20
+
+#define ACCOUNT 12345
+
+typedef struct corpusTransaction_t {
+    const char *name;
+    // Signing digest given by Transaction().encode of the functional tests
+    const char *digest;
+} corpusTransaction_t;
+
+static const corpusTransaction_t BATCH[] = {
+    {"transaction_batch_1", "7cc093871aff79a5f3b877e40eda9a29d71c7f1b2d72d7f30073d8f167b428ff"},
+    {"transaction_batch_2", "93ccfa5b22e2fbcb251adb0ae1d2ce9b72c71a2d71bb23603c74b9c55244faf0"},
+    {"transaction_batch_3", "33048916fd2da630ebf72ab602c4d6c51d4ed11e297a3e4cf2d5f1719e013eba"},
+};
+
+// Transactions the batch does not accept after the first one of BATCH
+static const char *const REJECTED[] = {
+    // A transfer with a memo
+    "transaction",
+    // A transfer from another account
+    "transaction_batch_other_sender",
+    // An action of another contract
+    "transaction_vote",
+    // No action, it would be signed without any row of the review
+    "transaction_batch_no_action",
+};
+
+// Not a transaction of the batch
+static const char *const OTHER_DIGEST =
+    "81d577769b39a6dc941624e2e4476da9e00e91078d74602f0764732b5ac6d928";
+
+// Review of BATCH: transfers to 2 recipients summed, then the total
+static const char *const REVIEW[][2] = {
+    {"Transactions", "3"},
+    {"From", "cryptofairy1"},
+    {"To #1", "lioninjungle"},
+    {"Amount #1", "1.5000 EOS"},
+    {"To #2", "eosnewyorkio"},
+    {"Amount #2", "2.5000 EOS"},
+    {"Total", "4.0000 EOS"},
+};
+
+static void parse_digest(const char *hex, uint8_t *digest) {
+    for (uint32_t i = 0; i < 32; i++) {
+        unsigned int byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        digest[i] = byte;
+    }
+}
+
+/**
+ * Send the transaction as index of a batch of count transactions, in SIGN commands of
+ * 255 bytes at most. Return the status word of the last one.
+ */
+static uint16_t send_batch_transaction(const char *name, uint8_t index, uint8_t count) {
+    const uint32_t path[] = {0x8000002C, 0x800000C2, 0x80000000 | ACCOUNT};
+    static uint8_t payload[1024];
+    char filename[64];
+    uint32_t length = 0;
+    FILE *f;
+
+    payload[length++] = index;
+    if (index == 0) {
+        payload[length++] = count;
+        payload[length++] = sizeof(path) / sizeof(path[0]);
+        for (uint32_t i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+            payload[length++] = path[i] >> 24;
+            payload[length++] = path[i] >> 16;
+            payload[length++] = path[i] >> 8;
+            payload[length++] = path[i];
+        }
+    }
+    snprintf(filename, sizeof(filename), CORPUS_DIRECTORY "%s", name);
+    f = fopen(filename, "rb");
+    if (f == NULL) {
+        printf("Can't open %s\n", filename);
+        return 0;
+    }
+    length += fread(payload + length, 1, sizeof(payload) - length, f);
+    fclose(f);
+    return exchange_sign(payload, length, P2_BATCH, &length);
+}
+
+/**
+ * Fetch the signature of a digest, and check that it is made over this digest with the
+ * key of the batch path. Return the status word.
+ */
+static uint16_t get_signature(const uint8_t *digest) {
+    uint32_t length;
+    uint16_t sw;
+
+    G_io_apdu_buffer[0] = CLA;
+    G_io_apdu_buffer[1] = INS_GET_LAST_SIGNATURE;
+    G_io_apdu_buffer[2] = 0;
+    G_io_apdu_buffer[3] = 0;
+    G_io_apdu_buffer[4] = 32;
+    memmove(G_io_apdu_buffer + 5, digest, 32);
+    sw = exchange_approved(&length);
+    if (sw != 0x9000) {
+        return sw;
+    }
+    if (length != 65) {
+        printf("Signature of %u bytes\n", length);
+        return 0;
+    }
+    // The mocked signature gives back its digest: s xored with r reversed
+    for (uint32_t i = 0; i < 32; i++) {
+        if ((G_io_apdu_buffer[33 + i] ^ G_io_apdu_buffer[32 - i]) != digest[i]) {
+            printf("Signature not made over its digest\n");
+            return 0;
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(g_last_signing_key); i++) {
+        if (g_last_signing_key[i] != (uint8_t) ((0x80000000 | ACCOUNT) >> (8 * (i % 4)))) {
+            printf("Signature not made with the key of the batch path\n");
+            return 0;
+        }
+    }
+    return sw;
+}
+
+/**
+ * Check the review of the batch, as rendered by printArgument.
+ */
+static bool check_review(void) {
+    if (strcmp(txContent.contract, "eosio.token") != 0 ||
+        strcmp(txContent.action, "transfer") != 0) {
+        printf("Review of %s %s\n", txContent.contract, txContent.action);
+        return false;
+    }
+    if (txContent.argumentCount != sizeof(REVIEW) / sizeof(REVIEW[0])) {
+        printf("Review of %d arguments\n", txContent.argumentCount);
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(REVIEW) / sizeof(REVIEW[0]); i++) {
+        printArgument(i, &txProcessingCtx);
+        printf("%s: %s\n", txContent.arg.label, txContent.arg.data);
+        if (strcmp(txContent.arg.label, REVIEW[i][0]) != 0 ||
+            strcmp(txContent.arg.data, REVIEW[i][1]) != 0) {
+            printf("Expected %s: %s\n", REVIEW[i][0], REVIEW[i][1]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stream and approve the batch, then fetch the signatures out of order.
+ */
+static bool check_batch(void) {
+    static const uint8_t ORDER[] = {2, 0, 1};
+    const uint8_t count = sizeof(BATCH) / sizeof(BATCH[0]);
+    uint8_t digest[32];
+    uint16_t sw;
+
+    wipe_signing_key();
+    clear_last_signature();
+    g_derivations = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        sw = send_batch_transaction(BATCH[i].name, i, count);
+        if (sw != 0x9000) {
+            printf("Transaction %u of the batch answered %04x\n", i, sw);
+            return false;
+        }
+    }
+    if (!txProcessingCtx.batchReview || !check_review()) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        parse_digest(BATCH[ORDER[i]].digest, digest);
+        sw = get_signature(digest);
+        if (sw != 0x9000) {
+            printf("Signature of transaction %u answered %04x\n", ORDER[i], sw);
+            return false;
+        }
+    }
+    printf("Batch of %u transactions: %u derivations\n", count, g_derivations);
+    if (g_derivations != 1) {
+        printf("The batch key is derived once\n");
+        return false;
+    }
+    parse_digest(OTHER_DIGEST, digest);
+    sw = get_signature(digest);
+    if (sw != 0x6A80) {
+        printf("Digest out of the batch answered %04x\n", sw);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * The transaction is rejected as the second one of a batch, and the batch is ended.
+ */
+static bool check_rejected(const char *name) {
+    uint8_t digest[32];
+    uint16_t sw;
+
+    wipe_signing_key();
+    clear_last_signature();
+    sw = send_batch_transaction(BATCH[0].name, 0, 2);
+    if (sw != 0x9000) {
+        printf("%s: first transaction of the batch answered %04x\n", name, sw);
+        return false;
+    }
+    sw = send_batch_transaction(name, 1, 2);
+    printf("%s in a batch: %04x\n", name, sw);
+    if (sw != 0x6A80) {
+        return false;
+    }
+    parse_digest(BATCH[0].digest, digest);
+    sw = get_signature(digest);
+    if (sw != 0x6985) {
+        printf("%s: signature of the ended batch answered %04x\n", name, sw);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * A batch of a transaction without action has nothing to review.
+ */
+static bool check_empty_batch(void) {
+    uint16_t sw;
+
+    wipe_signing_key();
+    clear_last_signature();
+    sw = send_batch_transaction("transaction_batch_no_action", 0, 1);
+    printf("Batch without action: %04x\n", sw);
+    return sw == 0x6A80;
+}
+
+int main(void) {
+    if (!check_batch() || !check_empty_batch()) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < sizeof(REJECTED) / sizeof(REJECTED[0]); i++) {
+        if (!check_rejected(REJECTED[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_stream.h"
+#include "main.h"
+#include "main_mocks.h"
+
+#define CORPUS_DIRECTORY "ref_corpus/"
+
+#define P2_REVIEW_AFTER_STREAM 0x04
+
+/**
+ * Sign a corpus transaction, approving each review. Return the status word.
+ */
+static uint16_t sign(const char *name, uint8_t p2) {
+    const uint32_t path[] = {0x8000002C, 0x800000C2, 0x80003039};
+    static uint8_t payload[2048];
+    char filename[64];
+    uint32_t length = 0;
+    FILE *f;
+
+    payload[length++] = sizeof(path) / sizeof(path[0]);
+    for (uint32_t i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+        payload[length++] = path[i] >> 24;
+        payload[length++] = path[i] >> 16;
+        payload[length++] = path[i] >> 8;
+        payload[length++] = path[i];
+    }
+    snprintf(filename, sizeof(filename), CORPUS_DIRECTORY "%s", name);
+    f = fopen(filename, "rb");
+    if (f == NULL) {
+        printf("Can't open %s\n", filename);
+        return 0;
+    }
+    length += fread(payload + length, 1, sizeof(payload) - length, f);
+    fclose(f);
+
+    wipe_signing_key();
+    clear_last_signature();
+    return exchange_sign(payload, length, p2, &length);
+}
+
+static bool check_sign(const char *name, uint8_t p2, uint16_t expected) {
+    uint16_t sw = sign(name, p2);
+
+    printf("%s, review %s: %04x\n",
+           name,
+           (p2 & P2_REVIEW_AFTER_STREAM) != 0 ? "after streaming" : "while streaming",
+           sw);
+    return sw == expected;
+}
+
+int main(void) {
+    // The actions of the transaction do not fit in the review queue, the host can sign it
+    // again with a review while streaming
+    if (!check_sign("transaction_vote", P2_REVIEW_AFTER_STREAM, 0x9000) ||
+        !check_sign("transaction_review_queue_full", P2_REVIEW_AFTER_STREAM, 0x6A80) ||
+        !check_sign("transaction_review_queue_full", 0, 0x9000)) {
+        return 1;
+    }
+    return 0;
+}
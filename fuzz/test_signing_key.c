@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "os.h"
+#include "cx.h"
+#include "eos_stream.h"
+#include "main.h"
+#include "main_mocks.h"
+
+#define TRANSACTION_FILE "ref_corpus/transaction"
+
+#define CLA                  0xD4
+#define INS_SIGN             0x04
+#define P1_FIRST             0x00
+#define P2_CACHE_SIGNING_KEY 0x08
+
+static uint8_t transaction[IO_APDU_BUFFER_SIZE];
+static uint32_t transactionLength;
+// Candidate signatures rejected as not canonical, by all the signatures
+static uint32_t rejectedCandidates;
+static uint32_t signedTransactions;
+
+/**
+ * Sign the reference transaction in a single SIGN command, approving each review.
+ * Return the status word.
+ */
+static uint16_t sign(uint32_t account, uint8_t p2) {
+    const uint32_t path[] = {0x8000002C, 0x800000C2, 0x80000000 | account};
+    uint32_t length = 0;
+
+    G_io_apdu_buffer[length++] = CLA;
+    G_io_apdu_buffer[length++] = INS_SIGN;
+    G_io_apdu_buffer[length++] = P1_FIRST;
+    G_io_apdu_buffer[length++] = p2;
+    G_io_apdu_buffer[length++] = 1 + sizeof(path) + transactionLength;
+    G_io_apdu_buffer[length++] = sizeof(path) / sizeof(path[0]);
+    for (uint32_t i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+        G_io_apdu_buffer[length++] = path[i] >> 24;
+        G_io_apdu_buffer[length++] = path[i] >> 16;
+        G_io_apdu_buffer[length++] = path[i] >> 8;
+        G_io_apdu_buffer[length++] = path[i];
+    }
+    memmove(G_io_apdu_buffer + length, transaction, transactionLength);
+    return exchange_approved(&length);
+}
+
+/**
+ * The rejected candidates kept by the app are the signatures made but the canonical one.
+ */
+static bool check_rejected_candidates(const char *name, uint32_t signatures) {
+    uint32_t rejected = tmpCtx.transactionContext.rejectedCandidates;
+
+    if (rejected != signatures - 1) {
+        printf("%s: %u rejected candidates out of %u signatures\n", name, rejected, signatures);
+        return false;
+    }
+    rejectedCandidates += rejected;
+    signedTransactions++;
+    return true;
+}
+
+/**
+ * Sign with the accounts in turn and check the number of key derivations, and that
+ * each signature is made with the key of its path.
+ */
+static bool check_derivations(const char *name,
+                              const uint32_t *accounts,
+                              uint32_t count,
+                              uint8_t p2,
+                              uint32_t expected) {
+    g_derivations = 0;
+    wipe_signing_key();
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t sw;
+
+        g_signatures = 0;
+        sw = sign(accounts[i], p2);
+        if (sw != 0x9000) {
+            printf("%s: signature %u answered %04x\n", name, i, sw);
+            return false;
+        }
+        if (!check_rejected_candidates(name, g_signatures)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < sizeof(g_last_signing_key); j++) {
+            if (g_last_signing_key[j] != (uint8_t) ((0x80000000 | accounts[i]) >> (8 * (j % 4)))) {
+                printf("%s: signature %u not made with the key of its path\n", name, i);
+                return false;
+            }
+        }
+    }
+    printf("%s: %u derivations\n", name, g_derivations);
+    if (g_derivations != expected) {
+        printf("%s: %u derivations expected\n", name, expected);
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    static const uint32_t SAME_PATH[] = {12345, 12345, 12345};
+    static const uint32_t PATH_CHANGES[] = {12345, 54321, 12345};
+    FILE *f = fopen(TRANSACTION_FILE, "rb");
+
+    if (f == NULL) {
+        printf("Can't open %s\n", TRANSACTION_FILE);
+        return 1;
+    }
+    transactionLength = fread(transaction, 1, 255 - 13, f);
+    fclose(f);
+
+    if (!check_derivations("Same path, cached key", SAME_PATH, 3, P2_CACHE_SIGNING_KEY, 1) ||
+        !check_derivations("Same path, key not cached", SAME_PATH, 3, 0, 3) ||
+        !check_derivations("Paths A, B, A, cached key", PATH_CHANGES, 3, P2_CACHE_SIGNING_KEY, 3)) {
+        return 1;
+    }
+    printf("%u rejected candidates for %u canonical signatures\n",
+           rejectedCandidates,
+           signedTransactions);
+    return 0;
+}
@@ -24,6 +24,9 @@
 #include <string.h>
 #include "ledger_assert.h"
 
+// End of a string cut to fit the display
+#define ELLIPSIS "..."
+
 void printString(const char in[], const char fieldName[], actionArgument_t *arg) {
     uint32_t inLength = strlen(in);
     uint32_t labelLength = strlen(fieldName);
@@ -92,7 +95,7 @@ void parseUint16Field(uint8_t *in,
     memmove(arg->label, fieldName, labelLength);
     uint16_t value;
     memmove(&value, in, sizeof(uint16_t));
-    snprintf(arg->data, sizeof(arg->data) - 1, "%d", value);
+    ui64toa(value, arg->data);
 
     *read = sizeof(uint16_t);
     *written = strlen(arg->data);
@@ -114,7 +117,7 @@ void parseUint32Field(uint8_t *in,
     memmove(arg->label, fieldName, labelLength);
     uint32_t value;
     memmove(&value, in, sizeof(uint32_t));
-    snprintf(arg->data, sizeof(arg->data) - 1, "%d", value);
+    ui64toa(value, arg->data);
 
     *read = sizeof(uint32_t);
     *written = strlen(arg->data);
@@ -180,15 +183,21 @@ void parseStringField(uint8_t *in,
 
     uint32_t fieldLength = 0;
     uint32_t readFromBuffer = unpack_variant32(in, inLength, &fieldLength);
-    LEDGER_ASSERT(fieldLength <= sizeof(arg->data) - 1, "parseActionData Insufficient buffer");
-    LEDGER_ASSERT(inLength >= fieldLength, "parseActionData Insufficient buffer");
+    LEDGER_ASSERT(inLength - readFromBuffer >= fieldLength, "parseActionData Insufficient buffer");
 
     in += readFromBuffer;
 
-    memmove(arg->data, in, fieldLength);
-
     *read = readFromBuffer + fieldLength;
-    *written = fieldLength;
+    if (fieldLength > sizeof(arg->data) - 1) {
+        // A string longer than the display, such as a memo of up to 256 bytes, is cut
+        // with an ellipsis
+        fieldLength = sizeof(arg->data) - 1 - (sizeof(ELLIPSIS) - 1);
+        memmove(arg->data + fieldLength, ELLIPSIS, sizeof(ELLIPSIS) - 1);
+        *written = sizeof(arg->data) - 1;
+    } else {
+        *written = fieldLength;
+    }
+    memmove(arg->data, in, fieldLength);
 }
 
 void parsePermissionField(uint8_t *in,
@@ -213,3 +222,429 @@ void parsePermissionField(uint8_t *in,
                accountWrittenLength;
     *read += sizeof(name_t);
 }
+
+// Size of the fixed size fields in the action data
+static const uint8_t FIELD_SIZES[FIELD_STRING] = {
+    [FIELD_NAME] = sizeof(name_t),
+    [FIELD_ASSET] = sizeof(asset_t),
+    [FIELD_BOOL] = sizeof(uint8_t),
+    [FIELD_UINT16] = sizeof(uint16_t),
+    [FIELD_UINT32] = sizeof(uint32_t),
+    [FIELD_UINT64] = sizeof(uint64_t),
+    // Key type followed by the compressed key
+    [FIELD_PUBLIC_KEY] = 1 + sizeof(public_key_t),
+    [FIELD_PERMISSION] = sizeof(permisssion_level_t),
+};
+
+#define DECODER_SIZE  0  // Reading the size of a string or a vector
+#define DECODER_VALUE 1  // Reading a fixed size value or the content of a string
+
+#define DECODER_NO_VECTOR 0xFF
+
+static bool isZeroField(const uint8_t *in, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        if (in[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Check an integer field value or a vector size against the field expectations.
+ */
+static void checkFieldValue(uint8_t flags, uint64_t value) {
+    LEDGER_ASSERT(!(flags & FIELD_EXPECT_ZERO) || value == 0, "checkFieldValue Must be 0");
+    LEDGER_ASSERT(!(flags & FIELD_EXPECT_ONE) || value == 1, "checkFieldValue Must be 1");
+}
+
+static void checkFixedField(const actionField_t *field, const uint8_t *in) {
+    uint64_t value = 0;
+
+    if ((field->flags & (FIELD_EXPECT_ZERO | FIELD_EXPECT_ONE)) == 0) {
+        return;
+    }
+    LEDGER_ASSERT(FIELD_SIZES[field->type] <= sizeof(value), "checkFixedField Not an integer");
+    memmove(&value, in, FIELD_SIZES[field->type]);
+    checkFieldValue(field->flags, value);
+}
+
+/**
+ * Whether the value of the current field is kept in the argument store: it is
+ * displayed, or needed to decide if it is displayed.
+ */
+static bool isFieldKept(const actionDecoder_t *decoder, const actionField_t *fields) {
+    if (decoder->vector != DECODER_NO_VECTOR && (fields[decoder->vector].flags & FIELD_HIDDEN)) {
+        return false;
+    }
+    return !(fields[decoder->field].flags & FIELD_HIDDEN);
+}
+
+static void startField(actionDecoder_t *decoder, const actionField_t *fields, uint8_t fieldCount) {
+    if (decoder->field >= fieldCount) {
+        decoder->done = true;
+        return;
+    }
+
+    uint8_t type = fields[decoder->field].type;
+    decoder->valuePos = 0;
+    if (type == FIELD_STRING || type == FIELD_VECTOR) {
+        decoder->phase = DECODER_SIZE;
+        varuint32_decoder_init(&decoder->sizeDecoder);
+    } else {
+        decoder->phase = DECODER_VALUE;
+        decoder->size = FIELD_SIZES[type];
+    }
+}
+
+/**
+ * Move to the next field, or to the first field of the next vector item.
+ */
+static void nextField(actionDecoder_t *decoder, const actionField_t *fields, uint8_t fieldCount) {
+    if (decoder->vector == DECODER_NO_VECTOR) {
+        decoder->field++;
+    } else {
+        uint8_t lastItemField = decoder->vector + fields[decoder->vector].param;
+        if (decoder->field < lastItemField) {
+            decoder->field++;
+        } else if (--decoder->itemsLeft > 0) {
+            decoder->field = decoder->vector + 1;
+        } else {
+            decoder->field = lastItemField + 1;
+            decoder->vector = DECODER_NO_VECTOR;
+        }
+    }
+    startField(decoder, fields, fieldCount);
+}
+
+/**
+ * Decode a byte of the size of a string or a vector (varuint32). Return false if the
+ * argument store is full.
+ */
+static bool decodeSizeByte(actionDecoder_t *decoder,
+                           const actionField_t *fields,
+                           uint8_t fieldCount,
+                           actionArgumentIndex_t *index,
+                           uint8_t *store,
+                           uint32_t storeSize,
+                           uint8_t byte) {
+    const actionField_t *field = &fields[decoder->field];
+
+    varuint32_status_e status = varuint32_decode_byte(&decoder->sizeDecoder, byte);
+    LEDGER_ASSERT(status != VARUINT32_INVALID, "decodeSizeByte Invalid size");
+    if (field->type == FIELD_STRING && isFieldKept(decoder, fields)) {
+        // Strings are kept with their size, as they are rendered
+        if (decoder->storeLength == storeSize) {
+            PRINTF("Argument store full\n");
+            return false;
+        }
+        store[decoder->storeLength++] = byte;
+    }
+    if (status == VARUINT32_PENDING) {
+        return true;
+    }
+    decoder->size = decoder->sizeDecoder.value;
+
+    checkFieldValue(field->flags, decoder->size);
+    LEDGER_ASSERT(decoder->list < ACTION_ARGUMENT_LIST_MAX, "decodeSizeByte Too many lists");
+    LEDGER_ASSERT(decoder->size <= UINT16_MAX, "decodeSizeByte Too many items");
+    index->listOffset[decoder->list] = decoder->storeLength;
+    index->listSize[decoder->list] = decoder->size;
+    decoder->list++;
+
+    if (field->type == FIELD_STRING) {
+        decoder->phase = DECODER_VALUE;
+        if (decoder->size == 0) {
+            nextField(decoder, fields, fieldCount);
+        }
+        return true;
+    }
+
+    LEDGER_ASSERT(decoder->vector == DECODER_NO_VECTOR && field->param < fieldCount - decoder->field,
+                  "decodeSizeByte Invalid schema");
+    for (uint8_t i = 1; i <= field->param; i++) {
+        LEDGER_ASSERT(field[i].type < FIELD_STRING, "decodeSizeByte Invalid schema");
+    }
+    if (decoder->size == 0) {
+        decoder->field += field->param;
+        nextField(decoder, fields, fieldCount);
+    } else {
+        decoder->vector = decoder->field;
+        decoder->itemsLeft = decoder->size;
+        decoder->field++;
+        startField(decoder, fields, fieldCount);
+    }
+    return true;
+}
+
+void initActionDecoder(actionDecoder_t *decoder, const actionSchema_t *schema) {
+    memset(decoder, 0, sizeof(actionDecoder_t));
+    decoder->vector = DECODER_NO_VECTOR;
+    startField(decoder, (const actionField_t *) PIC(schema->fields), schema->fieldCount);
+}
+
+/**
+ * Decode a chunk of an action data along its schema. The data comes in by chunks of any
+ * size, it is never buffered as a whole: values of the displayed fields are appended to
+ * the argument store, the other fields are checked and dropped, and the strings and
+ * vectors are recorded into the index. Return false if the displayed fields do not fit
+ * in the argument store.
+ */
+bool decodeActionData(actionDecoder_t *decoder,
+                      const actionSchema_t *schema,
+                      actionArgumentIndex_t *index,
+                      uint8_t *store,
+                      uint32_t storeSize,
+                      const uint8_t *in,
+                      uint32_t length) {
+    const actionField_t *fields = (const actionField_t *) PIC(schema->fields);
+    uint8_t fieldCount = schema->fieldCount;
+
+    while (length > 0 && !decoder->done) {
+        if (decoder->phase == DECODER_SIZE) {
+            if (!decodeSizeByte(decoder, fields, fieldCount, index, store, storeSize, *in)) {
+                return false;
+            }
+            in++;
+            length--;
+            continue;
+        }
+
+        const actionField_t *field = &fields[decoder->field];
+        bool kept = isFieldKept(decoder, fields);
+        uint32_t chunk = decoder->size - decoder->valuePos;
+        if (chunk > length) {
+            chunk = length;
+        }
+        // A value wholly present in the chunk is checked in place, otherwise it is
+        // gathered into the store, even if it is not kept
+        bool whole = decoder->valuePos == 0 && chunk == decoder->size;
+        const uint8_t *value = whole ? in : store + decoder->storeLength;
+        if (kept || (!whole && field->type != FIELD_STRING)) {
+            if (decoder->size > storeSize - decoder->storeLength) {
+                PRINTF("Argument store full\n");
+                return false;
+            }
+            memmove(store + decoder->storeLength + decoder->valuePos, in, chunk);
+        }
+        in += chunk;
+        length -= chunk;
+        decoder->valuePos += chunk;
+        if (decoder->valuePos < decoder->size) {
+            continue;
+        }
+
+        bool stop = false;
+        if (field->type != FIELD_STRING) {
+            checkFixedField(field, value);
+            stop = kept && (field->flags & FIELD_STOP_IF_SHOWN) &&
+                   !isZeroField(value, decoder->size);
+        }
+        if (kept) {
+            decoder->storeLength += decoder->size;
+        }
+        if (stop) {
+            decoder->done = true;
+        } else {
+            nextField(decoder, fields, fieldCount);
+        }
+    }
+    return true;
+}
+
+static void printField(const actionField_t *field,
+                       const char *label,
+                       uint8_t *in,
+                       uint32_t inLength,
+                       actionArgument_t *arg) {
+    uint32_t read = 0;
+    uint32_t written = 0;
+
+    switch (field->type) {
+        case FIELD_NAME:
+            if ((field->flags & FIELD_NULL_IF_ZERO) && isZeroField(in, sizeof(name_t))) {
+                printString("NULL", label, arg);
+            } else {
+                parseNameField(in, inLength, label, arg, &read, &written);
+            }
+            break;
+        case FIELD_ASSET:
+            parseAssetField(in, inLength, label, arg, &read, &written);
+            break;
+        case FIELD_BOOL:
+            printString(in[0] != 0 ? "Yes" : "No", label, arg);
+            break;
+        case FIELD_UINT16:
+            parseUint16Field(in, inLength, label, arg, &read, &written);
+            break;
+        case FIELD_UINT32:
+            parseUint32Field(in, inLength, label, arg, &read, &written);
+            break;
+        case FIELD_UINT64:
+            parseUInt64Field(in, inLength, label, arg, &read, &written);
+            break;
+        case FIELD_PUBLIC_KEY:
+            // Skip key type
+            parsePublicKeyField(in + 1, inLength - 1, label, arg, &read, &written);
+            break;
+        case FIELD_PERMISSION:
+            parsePermissionField(in, inLength, label, arg, &read, &written);
+            break;
+        case FIELD_STRING:
+            parseStringField(in, inLength, label, arg, &read, &written);
+            break;
+        default:
+            LEDGER_ASSERT(false, "printField Unsupported field");
+    }
+}
+
+/**
+ * Render argument argNum of a vector item kept in the argument store.
+ */
+static void printItemArgument(const actionField_t *items,
+                              uint8_t itemFieldCount,
+                              uint8_t *store,
+                              uint32_t storeLength,
+                              uint32_t offset,
+                              uint32_t item,
+                              uint32_t vectorSize,
+                              uint32_t argNum,
+                              actionArgument_t *arg) {
+    for (uint8_t i = 0; i < itemFieldCount; i++) {
+        const actionField_t *field = &items[i];
+        if (field->flags & FIELD_HIDDEN) {
+            continue;
+        }
+        if (argNum == 0) {
+            char label[sizeof(arg->label)] = {0};
+            snprintf(label,
+                     field->param != 0 ? field->param : sizeof(label),
+                     (const char *) PIC(field->label),
+                     item + 1,
+                     vectorSize);
+            LEDGER_ASSERT(FIELD_SIZES[field->type] <= storeLength - offset,
+                          "printItemArgument Insufficient buffer");
+            printField(field, label, store + offset, storeLength - offset, arg);
+            return;
+        }
+        argNum--;
+        offset += FIELD_SIZES[field->type];
+    }
+}
+
+/**
+ * Walk the argument store of an action along its schema.
+ * With arg set, argument argNum is rendered.
+ * Return the number of arguments to display, up to argNum when it is rendered.
+ */
+static uint32_t walkAction(const actionSchema_t *schema,
+                           uint8_t *store,
+                           uint32_t storeLength,
+                           const actionArgumentIndex_t *index,
+                           uint32_t argNum,
+                           actionArgument_t *arg) {
+    const actionField_t *fields = (const actionField_t *) PIC(schema->fields);
+    uint8_t fieldCount = schema->fieldCount;
+    uint32_t offset = 0;
+    uint32_t argCount = 0;
+    uint8_t list = 0;
+
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        const actionField_t *field = &fields[i];
+        const char *label = (const char *) PIC(field->label);
+
+        if (field->type == FIELD_STRING || field->type == FIELD_VECTOR) {
+            LEDGER_ASSERT(list < ACTION_ARGUMENT_LIST_MAX, "walkAction Too many lists");
+            uint32_t start = index->listOffset[list];
+            uint32_t size = index->listSize[list];
+            list++;
+
+            if (field->type == FIELD_STRING) {
+                if (field->flags & FIELD_HIDDEN) {
+                    continue;
+                }
+                if (!((field->flags & FIELD_IF_NONZERO) && size == 0)) {
+                    if (arg != NULL && argCount == argNum) {
+                        printField(field, label, store + offset, storeLength - offset, arg);
+                        return argCount;
+                    }
+                    argCount++;
+                }
+                offset = start + size;
+                continue;
+            }
+
+            const actionField_t *items = field + 1;
+            uint8_t itemFieldCount = field->param;
+            i += itemFieldCount;
+            if (field->flags & FIELD_HIDDEN) {
+                continue;
+            }
+
+            uint32_t itemSize = 0;
+            uint32_t itemArgCount = 0;
+            for (uint8_t j = 0; j < itemFieldCount; j++) {
+                if (!(items[j].flags & FIELD_HIDDEN)) {
+                    itemSize += FIELD_SIZES[items[j].type];
+                    itemArgCount++;
+                }
+            }
+            if (arg != NULL && argNum - argCount < size * itemArgCount) {
+                uint32_t item = (argNum - argCount) / itemArgCount;
+                printItemArgument(items,
+                                  itemFieldCount,
+                                  store,
+                                  storeLength,
+                                  start + item * itemSize,
+                                  item,
+                                  size,
+                                  (argNum - argCount) % itemArgCount,
+                                  arg);
+                return argNum;
+            }
+            argCount += size * itemArgCount;
+            offset = start + size * itemSize;
+            continue;
+        }
+
+        if (field->flags & FIELD_HIDDEN) {
+            continue;
+        }
+        uint32_t size = FIELD_SIZES[field->type];
+        LEDGER_ASSERT(size <= storeLength - offset, "walkAction Insufficient buffer");
+        if (!((field->flags & FIELD_IF_NONZERO) && isZeroField(store + offset, size))) {
+            if (arg != NULL && argCount == argNum) {
+                printField(field, label, store + offset, storeLength - offset, arg);
+                return argCount;
+            }
+            argCount++;
+            if (field->flags & FIELD_STOP_IF_SHOWN) {
+                break;
+            }
+        }
+        offset += size;
+    }
+    return argCount;
+}
+
+/**
+ * Count the arguments to display of a decoded action.
+ */
+uint32_t countActionArguments(const actionSchema_t *schema,
+                              uint8_t *store,
+                              uint32_t storeLength,
+                              const actionArgumentIndex_t *index) {
+    return walkAction(schema, store, storeLength, index, 0, NULL);
+}
+
+/**
+ * Render an argument of a decoded action.
+ */
+void printActionArgument(const actionSchema_t *schema,
+                         uint8_t *store,
+                         uint32_t storeLength,
+                         const actionArgumentIndex_t *index,
+                         uint8_t argNum,
+                         actionArgument_t *arg) {
+    walkAction(schema, store, storeLength, index, argNum, arg);
+}
@@ -18,13 +18,85 @@
 #ifndef __EOS_PARSE_H__
 #define __EOS_PARSE_H__
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "eos_types.h"
 
 typedef struct actionArgument_t {
     char label[32];
     char data[128];
 } actionArgument_t;
 
+#define ACTION_ARGUMENT_LIST_MAX 6
+
+/**
+ * Offsets in the argument store and sizes of the variable length fields (strings and
+ * vectors) of an action data, in schema order. They are recorded while the data is
+ * decoded. Vector items have a fixed size, so the offset of any argument is derived
+ * from this index without decoding the data again.
+ */
+typedef struct actionArgumentIndex_t {
+    uint16_t listOffset[ACTION_ARGUMENT_LIST_MAX];
+    uint16_t listSize[ACTION_ARGUMENT_LIST_MAX];
+} actionArgumentIndex_t;
+
+typedef enum actionFieldType_e {
+    FIELD_NAME,
+    FIELD_ASSET,
+    FIELD_BOOL,
+    FIELD_UINT16,
+    FIELD_UINT32,
+    FIELD_UINT64,
+    FIELD_PUBLIC_KEY,
+    FIELD_PERMISSION,
+    FIELD_STRING,
+    // Followed by the fields of an item, they must have a fixed size
+    FIELD_VECTOR,
+} actionFieldType_e;
+
+// Display conditions
+#define FIELD_HIDDEN        0x01  // Decoded but not displayed
+#define FIELD_IF_NONZERO    0x02  // Displayed if the value is not zero or empty
+#define FIELD_NULL_IF_ZERO  0x04  // A zero name is displayed as "NULL"
+#define FIELD_STOP_IF_SHOWN 0x08  // The following fields are not displayed if this one is
+// Value checks, on the size of a vector
+#define FIELD_EXPECT_ZERO 0x10
+#define FIELD_EXPECT_ONE  0x20
+
+typedef struct actionField_t {
+    uint8_t type;
+    uint8_t flags;
+    // FIELD_VECTOR: number of item fields following it.
+    // Item fields: size of the label buffer if shorter than actionArgument_t label.
+    uint8_t param;
+    // Item fields label is a format taking the item number and the vector size
+    const char *label;
+} actionField_t;
+
+typedef struct actionSchema_t {
+    const actionField_t *fields;
+    uint8_t fieldCount;
+} actionSchema_t;
+
+#define ACTION_SCHEMA(fields) \
+    { fields, sizeof(fields) / sizeof(fields[0]) }
+
+/**
+ * State of the incremental decoding of an action data along its schema.
+ */
+typedef struct actionDecoder_t {
+    uint32_t size;                    // Size of the current value, string or vector
+    varuint32_decoder_t sizeDecoder;  // Size of the current string or vector, as it is read
+    uint32_t valuePos;                // Bytes of the current value already decoded
+    uint16_t itemsLeft;               // Items of the current vector left to decode
+    uint16_t storeLength;             // Bytes appended to the argument store
+    uint8_t field;                    // Current field in the schema
+    uint8_t vector;                   // Current vector field in the schema, if any
+    uint8_t list;                     // Next entry of the argument index
+    uint8_t phase;
+    bool done;
+} actionDecoder_t;
+
 void printString(const char in[], const char fieldName[], actionArgument_t *arg);
 void parseNameField(uint8_t *in,
                     uint32_t inLength,
@@ -75,4 +147,23 @@ void parsePermissionField(uint8_t *in,
                           uint32_t *read,
                           uint32_t *written);
 
+void initActionDecoder(actionDecoder_t *decoder, const actionSchema_t *schema);
+bool decodeActionData(actionDecoder_t *decoder,
+                      const actionSchema_t *schema,
+                      actionArgumentIndex_t *index,
+                      uint8_t *store,
+                      uint32_t storeSize,
+                      const uint8_t *in,
+                      uint32_t length);
+uint32_t countActionArguments(const actionSchema_t *schema,
+                              uint8_t *store,
+                              uint32_t storeLength,
+                              const actionArgumentIndex_t *index);
+void printActionArgument(const actionSchema_t *schema,
+                         uint8_t *store,
+                         uint32_t storeLength,
+                         const actionArgumentIndex_t *index,
+                         uint8_t argNum,
+                         actionArgument_t *arg);
+
 #endif
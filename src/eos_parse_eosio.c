@@ -15,436 +15,118 @@
  *  limitations under the License.
  ********************************************************************************/
 
-#include <string.h>
+#include <stddef.h>
 
 #include "eos_parse_eosio.h"
-#include "eos_types.h"
-#include "os.h"
 
-void parseDelegate(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "From", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Receiver", arg, &read, &written);
-    } else if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseAssetField(buffer, bufferLength, "NET", arg, &read, &written);
-    } else if (argNum == 3) {
-        buffer += 2 * sizeof(name_t) + sizeof(asset_t);
-        bufferLength -= 2 * sizeof(name_t) + sizeof(asset_t);
-        parseAssetField(buffer, bufferLength, "CPU", arg, &read, &written);
-    } else if (argNum == 4) {
-        printString("Yes", "Transfer Stake", arg);
-    }
-}
-
-void parseUndelegate(uint8_t *buffer,
-                     uint32_t bufferLength,
-                     uint8_t argNum,
-                     actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "From", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Receiver", arg, &read, &written);
-    } else if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseAssetField(buffer, bufferLength, "NET", arg, &read, &written);
-    } else if (argNum == 3) {
-        buffer += 2 * sizeof(name_t) + sizeof(asset_t);
-        bufferLength -= 2 * sizeof(name_t) + sizeof(asset_t);
-        parseAssetField(buffer, bufferLength, "CPU", arg, &read, &written);
-    }
-}
-
-void parseRefund(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-    }
-}
-
-void parseBuyRam(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Buyer", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Receiver", arg, &read, &written);
-    } else if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseAssetField(buffer, bufferLength, "Tokens", arg, &read, &written);
-    }
-}
-
-void parseBuyRamBytes(uint8_t *buffer,
-                      uint32_t bufferLength,
-                      uint8_t argNum,
-                      actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Buyer", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Receiver", arg, &read, &written);
-    } else if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseUint32Field(buffer, bufferLength, "Bytes", arg, &read, &written);
-    }
-}
-
-void parseSellRam(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Receiver", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseUInt64Field(buffer, bufferLength, "Bytes", arg, &read, &written);
-    }
-}
-
-void parseVoteProducer(uint8_t *buffer,
-                       uint32_t bufferLength,
-                       uint8_t argNum,
-                       actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    uint8_t *proxyBuffer = buffer + sizeof(name_t);
-    name_t proxy = 0;
-    memmove(&proxy, proxyBuffer, sizeof(name_t));
-    if (proxy != 0 && argNum == 1) {
-        parseNameField(proxyBuffer, sizeof(name_t), "Proxy", arg, &read, &written);
-        return;
-    }
-
-    // Move to producers list
-    buffer += 2 * sizeof(name_t);
-    bufferLength -= 2 * sizeof(name_t);
-
-    uint32_t totalProducers = 0;
-    read = unpack_variant32(buffer, bufferLength, &totalProducers);
-    buffer += read;
-    bufferLength -= read;
-
-    uint32_t producerIndex = argNum - 1;
-    buffer += producerIndex * sizeof(name_t);
-    bufferLength -= producerIndex * sizeof(name_t);
-
-    char label[14] = {0};
-    snprintf(label, sizeof(label) - 1, "Producer #%d [%d]", argNum, totalProducers);
-    parseNameField(buffer, bufferLength, label, arg, &read, &written);
-}
-
-void parseUpdateAuth(uint8_t *buffer,
-                     uint32_t bufferLength,
-                     uint8_t argNum,
-                     actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Permission", arg, &read, &written);
-        return;
-    }
-
-    uint8_t *parentBuffer = buffer + 2 * sizeof(name_t);
-    name_t parent = 0;
-    memmove(&parent, parentBuffer, sizeof(name_t));
-    if (parent != 0 && argNum == 2) {
-        parseNameField(parentBuffer, sizeof(name_t), "Parent", arg, &read, &written);
-        return;
-    } else if (argNum == 2) {
-        uint8_t null[] = {4, 'N', 'U', 'L', 'L'};
-        parseStringField(null, sizeof(null), "Parent", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 3) {
-        buffer += 3 * sizeof(name_t);
-        bufferLength -= 3 * sizeof(name_t);
-        parseUint32Field(buffer, bufferLength, "Threshold", arg, &read, &written);
-        return;
-    }
-
-    uint32_t prefixLength = 3 * sizeof(name_t) + sizeof(uint32_t);
-    buffer += prefixLength;
-    bufferLength -= prefixLength;
-    uint8_t *keys = buffer;
-    uint32_t keyBufferLength = bufferLength;
-
-    uint32_t totalKeys = 0;
-    read = unpack_variant32(keys, keyBufferLength, &totalKeys);
-    keys += read;
-    keyBufferLength -= read;
-
-    uint8_t keysArgStart = 3;
-
-    if (keysArgStart < argNum && argNum <= keysArgStart + totalKeys * 2) {
-        for (uint8_t i = 0, argIndex = keysArgStart + 1; i < totalKeys; ++i, argIndex += 2) {
-            char label[32] = {0};
-            // Skip key Type
-            keys += 1;
-            keyBufferLength -= 1;
-
-            if (argIndex == argNum) {
-                snprintf(label, sizeof(label), "Key #%d", (i + 1));
-                parsePublicKeyField(keys, keyBufferLength, label, arg, &read, &written);
-                return;
-            }
-
-            keys += sizeof(public_key_t);
-            keyBufferLength -= sizeof(public_key_t);
-
-            if (argIndex + 1 == argNum) {
-                snprintf(label, sizeof(label), "Key #%d Weight", (i + 1));
-                parseUint16Field(keys, keyBufferLength, label, arg, &read, &written);
-                return;
-            }
-
-            keys += sizeof(uint16_t);
-            keyBufferLength -= sizeof(uint16_t);
-        }
-    }
-
-    // Accounts
-    const uint32_t keyStep = (1 + sizeof(public_key_t) + sizeof(uint16_t));
-    uint8_t *accounts = keys + keyStep * totalKeys;
-    uint32_t accountsBufferLen = keyBufferLength - keyStep * totalKeys;
-
-    uint32_t totalAccounts = 0;
-    read = unpack_variant32(accounts, accountsBufferLen, &totalAccounts);
-    accounts += read;
-    accountsBufferLen -= read;
-
-    uint32_t accountsArgStart = keysArgStart + totalKeys * 2;
-
-    if (accountsArgStart < argNum && argNum <= accountsArgStart + totalAccounts * 2) {
-        for (uint8_t i = 0, argIndex = accountsArgStart + 1; i < totalAccounts;
-             ++i, argIndex += 2) {
-            char label[32] = {0};
-            if (argIndex == argNum) {
-                snprintf(label, sizeof(label), "Account #%d", (i + 1));
-                parsePermissionField(accounts, accountsBufferLen, label, arg, &read, &written);
-                return;
-            }
-
-            accounts += sizeof(permisssion_level_t);
-            accountsBufferLen -= sizeof(permisssion_level_t);
-
-            if (argIndex + 1 == argNum) {
-                snprintf(label, sizeof(label), "Account #%d Weight", (i + 1));
-                parseUint16Field(accounts, accountsBufferLen, label, arg, &read, &written);
-                return;
-            }
-
-            accounts += sizeof(uint16_t);
-            accountsBufferLen -= sizeof(uint16_t);
-        }
-    }
-
-    // Delays
-    const uint32_t accountStep = sizeof(permisssion_level_t) + sizeof(uint16_t);
-    uint8_t *delays = accounts + accountStep * totalAccounts;
-    uint32_t delayBufferLen = accountsBufferLen - accountStep * totalAccounts;
-
-    uint32_t totalDelays = 0;
-    read = unpack_variant32(delays, delayBufferLen, &totalDelays);
-    delays += read;
-    delayBufferLen -= read;
-
-    uint32_t delaysArgStart = keysArgStart + totalKeys * 2 + totalAccounts * 2;
-
-    if (delaysArgStart < argNum && argNum <= delaysArgStart + totalDelays * 2) {
-        for (uint8_t i = 0, argIndex = delaysArgStart + 1; i < totalDelays; ++i, argIndex += 2) {
-            char label[32] = {0};
-
-            if (argIndex == argNum) {
-                snprintf(label, sizeof(label), "Delay #%d", (i + 1));
-                parseUint32Field(delays, delayBufferLen, label, arg, &read, &written);
-                return;
-            }
-
-            delays += sizeof(uint32_t);
-            delayBufferLen -= sizeof(uint32_t);
-
-            if (argIndex + 1 == argNum) {
-                snprintf(label, sizeof(label), "Delay #%d Weight", (i + 1));
-                parseUint16Field(delays, delayBufferLen, label, arg, &read, &written);
-                return;
-            }
-
-            delays += sizeof(uint16_t);
-            delayBufferLen -= sizeof(uint16_t);
-        }
-    }
-}
-
-void parseDeleteAuth(uint8_t *buffer,
-                     uint32_t bufferLength,
-                     uint8_t argNum,
-                     actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Permission", arg, &read, &written);
-        return;
-    }
-}
-
-void parseLinkAuth(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Contract", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Action", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 3) {
-        buffer += 3 * sizeof(name_t);
-        bufferLength -= 3 * sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Permission", arg, &read, &written);
-        return;
-    }
-}
-
-void parseUnlinkAuth(uint8_t *buffer,
-                     uint32_t bufferLength,
-                     uint8_t argNum,
-                     actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Contract", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Action", arg, &read, &written);
-        return;
-    }
-}
-
-void parseNewAccount(uint8_t *buffer,
-                     uint32_t bufferLength,
-                     uint8_t argNum,
-                     actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
-
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "Creator", arg, &read, &written);
-        return;
-    }
-
-    if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "Account", arg, &read, &written);
-        return;
-    }
-
-    // Offset to auth structures: owner, active
-    buffer += 2 * sizeof(name_t);
-    bufferLength -= 2 * sizeof(name_t);
-    // offset to owner key; skip threshold
-    buffer += sizeof(uint32_t);
-    bufferLength -= sizeof(uint32_t);
-    // skip key counter and key type
-    buffer += 2;
-    bufferLength -= 2;
-
-    if (argNum == 2) {
-        parsePublicKeyField(buffer, bufferLength, "Owner key", arg, &read, &written);
-        return;
-    }
-    // skip public key
-    buffer += sizeof(public_key_t) + sizeof(uint16_t);
-    bufferLength -= sizeof(public_key_t) + sizeof(uint16_t);
-    // skip accounts, delays
-    // Offset to "active"
-    buffer += 2;
-    bufferLength -= 2;
-
-    // skip threshold
-    // offset to active key; skip threshold
-    buffer += sizeof(uint32_t);
-    bufferLength -= sizeof(uint32_t);
-    // skip key counter and key type
-    buffer += 2;
-    bufferLength -= 2;
-
-    if (argNum == 3) {
-        parsePublicKeyField(buffer, bufferLength, "Active key", arg, &read, &written);
-        return;
-    }
-}
+static const actionField_t DELEGATEBW_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "From"},
+    {FIELD_NAME, 0, 0, "Receiver"},
+    {FIELD_ASSET, 0, 0, "NET"},
+    {FIELD_ASSET, 0, 0, "CPU"},
+    {FIELD_BOOL, FIELD_IF_NONZERO, 0, "Transfer Stake"},
+};
+
+static const actionField_t UNDELEGATEBW_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "From"},
+    {FIELD_NAME, 0, 0, "Receiver"},
+    {FIELD_ASSET, 0, 0, "NET"},
+    {FIELD_ASSET, 0, 0, "CPU"},
+};
+
+static const actionField_t REFUND_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+};
+
+static const actionField_t BUYRAM_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Buyer"},
+    {FIELD_NAME, 0, 0, "Receiver"},
+    {FIELD_ASSET, 0, 0, "Tokens"},
+};
+
+static const actionField_t BUYRAMBYTES_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Buyer"},
+    {FIELD_NAME, 0, 0, "Receiver"},
+    {FIELD_UINT32, 0, 0, "Bytes"},
+};
+
+static const actionField_t SELLRAM_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Receiver"},
+    {FIELD_UINT64, 0, 0, "Bytes"},
+};
+
+// Producers are not displayed when voting through a proxy. The producer label is
+// limited to 12 characters, as it has always been displayed.
+static const actionField_t VOTEPRODUCER_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+    {FIELD_NAME, FIELD_IF_NONZERO | FIELD_STOP_IF_SHOWN, 0, "Proxy"},
+    {FIELD_VECTOR, 0, 1, NULL},
+    {FIELD_NAME, 0, 13, "Producer #%d [%d]"},
+};
+
+static const actionField_t UPDATEAUTH_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+    {FIELD_NAME, 0, 0, "Permission"},
+    {FIELD_NAME, FIELD_NULL_IF_ZERO, 0, "Parent"},
+    {FIELD_UINT32, 0, 0, "Threshold"},
+    {FIELD_VECTOR, 0, 2, NULL},
+    {FIELD_PUBLIC_KEY, 0, 0, "Key #%d"},
+    {FIELD_UINT16, 0, 0, "Key #%d Weight"},
+    {FIELD_VECTOR, 0, 2, NULL},
+    {FIELD_PERMISSION, 0, 0, "Account #%d"},
+    {FIELD_UINT16, 0, 0, "Account #%d Weight"},
+    {FIELD_VECTOR, 0, 2, NULL},
+    {FIELD_UINT32, 0, 0, "Delay #%d"},
+    {FIELD_UINT16, 0, 0, "Delay #%d Weight"},
+};
+
+static const actionField_t DELETEAUTH_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+    {FIELD_NAME, 0, 0, "Permission"},
+};
+
+static const actionField_t LINKAUTH_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+    {FIELD_NAME, 0, 0, "Contract"},
+    {FIELD_NAME, 0, 0, "Action"},
+    {FIELD_NAME, 0, 0, "Permission"},
+};
+
+static const actionField_t UNLINKAUTH_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Account"},
+    {FIELD_NAME, 0, 0, "Contract"},
+    {FIELD_NAME, 0, 0, "Action"},
+};
+
+// Only single key authorities are accepted for a new account
+#define SINGLE_KEY_AUTHORITY(keyLabel)                             \
+    {FIELD_UINT32, FIELD_HIDDEN | FIELD_EXPECT_ONE, 0, NULL},      \
+    {FIELD_VECTOR, FIELD_EXPECT_ONE, 2, NULL},                     \
+    {FIELD_PUBLIC_KEY, 0, 0, keyLabel},                            \
+    {FIELD_UINT16, FIELD_HIDDEN | FIELD_EXPECT_ONE, 0, NULL},      \
+    {FIELD_VECTOR, FIELD_HIDDEN | FIELD_EXPECT_ZERO, 2, NULL},     \
+    {FIELD_PERMISSION, FIELD_HIDDEN, 0, NULL},                     \
+    {FIELD_UINT16, FIELD_HIDDEN, 0, NULL},                         \
+    {FIELD_VECTOR, FIELD_HIDDEN | FIELD_EXPECT_ZERO, 2, NULL},     \
+    {FIELD_UINT32, FIELD_HIDDEN, 0, NULL},                         \
+    {FIELD_UINT16, FIELD_HIDDEN, 0, NULL}
+
+static const actionField_t NEWACCOUNT_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "Creator"},
+    {FIELD_NAME, 0, 0, "Account"},
+    SINGLE_KEY_AUTHORITY("Owner key"),
+    SINGLE_KEY_AUTHORITY("Active key"),
+};
+
+const actionSchema_t EOSIO_DELEGATEBW_SCHEMA = ACTION_SCHEMA(DELEGATEBW_FIELDS);
+const actionSchema_t EOSIO_UNDELEGATEBW_SCHEMA = ACTION_SCHEMA(UNDELEGATEBW_FIELDS);
+const actionSchema_t EOSIO_REFUND_SCHEMA = ACTION_SCHEMA(REFUND_FIELDS);
+const actionSchema_t EOSIO_BUYRAM_SCHEMA = ACTION_SCHEMA(BUYRAM_FIELDS);
+const actionSchema_t EOSIO_BUYRAMBYTES_SCHEMA = ACTION_SCHEMA(BUYRAMBYTES_FIELDS);
+const actionSchema_t EOSIO_SELLRAM_SCHEMA = ACTION_SCHEMA(SELLRAM_FIELDS);
+const actionSchema_t EOSIO_VOTEPRODUCER_SCHEMA = ACTION_SCHEMA(VOTEPRODUCER_FIELDS);
+const actionSchema_t EOSIO_UPDATEAUTH_SCHEMA = ACTION_SCHEMA(UPDATEAUTH_FIELDS);
+const actionSchema_t EOSIO_DELETEAUTH_SCHEMA = ACTION_SCHEMA(DELETEAUTH_FIELDS);
+const actionSchema_t EOSIO_LINKAUTH_SCHEMA = ACTION_SCHEMA(LINKAUTH_FIELDS);
+const actionSchema_t EOSIO_UNLINKAUTH_SCHEMA = ACTION_SCHEMA(UNLINKAUTH_FIELDS);
+const actionSchema_t EOSIO_NEWACCOUNT_SCHEMA = ACTION_SCHEMA(NEWACCOUNT_FIELDS);
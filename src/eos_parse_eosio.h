@@ -20,23 +20,17 @@
 
 #include "eos_parse.h"
 
-void parseDelegate(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseUndelegate(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseRefund(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseBuyRam(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseBuyRamBytes(uint8_t *buffer,
-                      uint32_t bufferLength,
-                      uint8_t argNum,
-                      actionArgument_t *arg);
-void parseSellRam(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseVoteProducer(uint8_t *buffer,
-                       uint32_t bufferLength,
-                       uint8_t argNum,
-                       actionArgument_t *arg);
-void parseUpdateAuth(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseDeleteAuth(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseLinkAuth(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseUnlinkAuth(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
-void parseNewAccount(uint8_t *buffer, uint32_t bufferLength, uint8_t argNum, actionArgument_t *arg);
+extern const actionSchema_t EOSIO_DELEGATEBW_SCHEMA;
+extern const actionSchema_t EOSIO_UNDELEGATEBW_SCHEMA;
+extern const actionSchema_t EOSIO_REFUND_SCHEMA;
+extern const actionSchema_t EOSIO_BUYRAM_SCHEMA;
+extern const actionSchema_t EOSIO_BUYRAMBYTES_SCHEMA;
+extern const actionSchema_t EOSIO_SELLRAM_SCHEMA;
+extern const actionSchema_t EOSIO_VOTEPRODUCER_SCHEMA;
+extern const actionSchema_t EOSIO_UPDATEAUTH_SCHEMA;
+extern const actionSchema_t EOSIO_DELETEAUTH_SCHEMA;
+extern const actionSchema_t EOSIO_LINKAUTH_SCHEMA;
+extern const actionSchema_t EOSIO_UNLINKAUTH_SCHEMA;
+extern const actionSchema_t EOSIO_NEWACCOUNT_SCHEMA;
 
 #endif
@@ -16,28 +16,12 @@
  ********************************************************************************/
 
 #include "eos_parse_token.h"
-#include "eos_types.h"
 
-void parseTokenTransfer(uint8_t *buffer,
-                        uint32_t bufferLength,
-                        uint8_t argNum,
-                        actionArgument_t *arg) {
-    uint32_t read = 0;
-    uint32_t written = 0;
+static const actionField_t TRANSFER_FIELDS[] = {
+    {FIELD_NAME, 0, 0, "From"},
+    {FIELD_NAME, 0, 0, "To"},
+    {FIELD_ASSET, 0, 0, "Quantity"},
+    {FIELD_STRING, FIELD_IF_NONZERO, 0, "Memo"},
+};
 
-    if (argNum == 0) {
-        parseNameField(buffer, bufferLength, "From", arg, &read, &written);
-    } else if (argNum == 1) {
-        buffer += sizeof(name_t);
-        bufferLength -= sizeof(name_t);
-        parseNameField(buffer, bufferLength, "To", arg, &read, &written);
-    } else if (argNum == 2) {
-        buffer += 2 * sizeof(name_t);
-        bufferLength -= 2 * sizeof(name_t);
-        parseAssetField(buffer, bufferLength, "Quantity", arg, &read, &written);
-    } else if (argNum == 3) {
-        buffer += 2 * sizeof(name_t) + sizeof(asset_t);
-        bufferLength -= 2 * sizeof(name_t) + sizeof(asset_t);
-        parseStringField(buffer, bufferLength, "Memo", arg, &read, &written);
-    }
-}
+const actionSchema_t TOKEN_TRANSFER_SCHEMA = ACTION_SCHEMA(TRANSFER_FIELDS);
@@ -20,9 +20,6 @@
 
 #include "eos_parse.h"
 
-void parseTokenTransfer(uint8_t *buffer,
-                        uint32_t bufferLength,
-                        uint8_t argNum,
-                        actionArgument_t *arg);
+extern const actionSchema_t TOKEN_TRANSFER_SCHEMA;
 
 #endif
@@ -15,6 +15,7 @@
  *  limitations under the License.
  ********************************************************************************/
 
+#include <stddef.h>
 #include <string.h>
 #include "ledger_assert.h"
 #include "eos_stream.h"
@@ -48,13 +49,20 @@ void initTxContext(txProcessingContext_t *context,
                    cx_sha256_t *sha256,
                    cx_sha256_t *dataSha256,
                    txProcessingContent_t *processingContent,
-                   uint8_t dataAllowed) {
+                   uint8_t dataAllowed,
+                   bool packed,
+                   reviewQueue_t *reviewQueue) {
     memset(context, 0, sizeof(txProcessingContext_t));
     context->sha256 = sha256;
     context->dataSha256 = dataSha256;
     context->content = processingContent;
     context->state = TLV_CHAIN_ID;
     context->dataAllowed = dataAllowed;
+    context->packed = packed;
+    context->reviewQueue = reviewQueue;
+    if (reviewQueue != NULL) {
+        reviewQueue->length = 0;
+    }
     cx_sha256_init(context->sha256);
     cx_sha256_init(context->dataSha256);
 }
@@ -68,316 +76,243 @@ uint8_t readTxByte(txProcessingContext_t *context) {
     return data;
 }
 
-static void processTokenTransfer(txProcessingContext_t *context) {
+static void processUnknownAction(txProcessingContext_t *context) {
+    CX_ASSERT(cx_hash_no_throw(&context->dataSha256->header,
+                               CX_LAST,
+                               context->dataChecksum,
+                               0,
+                               context->dataChecksum,
+                               sizeof(context->dataChecksum)));
     context->content->argumentCount = 3;
-    uint32_t bufferLength = context->currentActionDataBufferLength;
-    uint8_t *buffer = context->actionDataBuffer;
-
-    buffer += 2 * sizeof(name_t) + sizeof(asset_t);
-    bufferLength -= 2 * sizeof(name_t) + sizeof(asset_t);
-    uint32_t memoLength = 0;
-    unpack_variant32(buffer, bufferLength, &memoLength);
-    if (memoLength > 0) {
-        context->content->argumentCount++;
-    }
 }
 
-static void processEosioDelegate(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-    uint8_t *buffer = context->actionDataBuffer;
+// Match the action name whatever the contract, token contracts share the transfer action
+#define ACTION_ANY_CONTRACT 0x01
 
-    buffer += 2 * sizeof(name_t) + 2 * sizeof(asset_t);
+typedef struct actionDescriptor_t {
+    name_t contract;
+    name_t action;
+    const actionSchema_t *schema;
+    uint8_t flags;
+} actionDescriptor_t;
 
-    if (buffer[0] != 0) {
-        context->content->argumentCount += 1;
-    }
-}
-
-static void processEosioUndelegate(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-}
-
-static void processEosioRefund(txProcessingContext_t *context) {
-    context->content->argumentCount = 1;
-}
+/**
+ * Actions displayed in clear, their arguments are described by their schema.
+ * Any other action is an unknown action and is only accepted as blind signed data.
+ */
+static const actionDescriptor_t ACTIONS[] = {
+    {0, EOSIO_TOKEN_TRANSFER, &TOKEN_TRANSFER_SCHEMA, ACTION_ANY_CONTRACT},
+    {EOSIO, EOSIO_DELEGATEBW, &EOSIO_DELEGATEBW_SCHEMA, 0},
+    {EOSIO, EOSIO_UNDELEGATEBW, &EOSIO_UNDELEGATEBW_SCHEMA, 0},
+    {EOSIO, EOSIO_REFUND, &EOSIO_REFUND_SCHEMA, 0},
+    {EOSIO, EOSIO_BUYRAM, &EOSIO_BUYRAM_SCHEMA, 0},
+    {EOSIO, EOSIO_BUYRAMBYTES, &EOSIO_BUYRAMBYTES_SCHEMA, 0},
+    {EOSIO, EOSIO_SELLRAM, &EOSIO_SELLRAM_SCHEMA, 0},
+    {EOSIO, EOSIO_VOTEPRODUCER, &EOSIO_VOTEPRODUCER_SCHEMA, 0},
+    {EOSIO, EOSIO_UPDATE_AUTH, &EOSIO_UPDATEAUTH_SCHEMA, 0},
+    {EOSIO, EOSIO_DELETE_AUTH, &EOSIO_DELETEAUTH_SCHEMA, 0},
+    {EOSIO, EOSIO_LINK_AUTH, &EOSIO_LINKAUTH_SCHEMA, 0},
+    {EOSIO, EOSIO_UNLINK_AUTH, &EOSIO_UNLINKAUTH_SCHEMA, 0},
+    {EOSIO, EOSIO_NEW_ACCOUNT, &EOSIO_NEWACCOUNT_SCHEMA, 0},
+};
 
-static void processEosioBuyRam(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
+/**
+ * Look up the descriptor of an action, return NULL for an unknown action.
+ */
+static const actionDescriptor_t *findAction(name_t contractName, name_t actionName) {
+    for (uint32_t i = 0; i < sizeof(ACTIONS) / sizeof(ACTIONS[0]); i++) {
+        const actionDescriptor_t *descriptor = &ACTIONS[i];
+        if (descriptor->action == actionName &&
+            ((descriptor->flags & ACTION_ANY_CONTRACT) || descriptor->contract == contractName)) {
+            return descriptor;
+        }
+    }
+    return NULL;
 }
 
-static void processEosioSellRam(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
+/**
+ * Render argument argNum of the review of a batch: the number of transactions, the
+ * sender, the amount sent to each recipient and the total of each token.
+ */
+static void printBatchArgument(uint8_t argNum, const batchSummary_t *batch, actionArgument_t *arg) {
+    char label[sizeof(arg->label)] = {0};
+    char count[4] = {0};
+    uint32_t read;
+    uint32_t written;
+
+    if (argNum == 0) {
+        snprintf(count, sizeof(count), "%d", batch->transactionCount);
+        printString(count, "Transactions", arg);
+    } else if (argNum == 1) {
+        parseNameField((uint8_t *) &batch->from, sizeof(name_t), "From", arg, &read, &written);
+    } else if (argNum < 2 + 2 * batch->recipientCount) {
+        uint8_t recipient = (argNum - 2) / 2;
+        if ((argNum - 2) % 2 == 0) {
+            snprintf(label, sizeof(label), "To #%d", recipient + 1);
+            parseNameField((uint8_t *) &batch->recipients[recipient],
+                           sizeof(name_t),
+                           label,
+                           arg,
+                           &read,
+                           &written);
+        } else {
+            snprintf(label, sizeof(label), "Amount #%d", recipient + 1);
+            parseAssetField((uint8_t *) &batch->amounts[recipient],
+                            sizeof(asset_t),
+                            label,
+                            arg,
+                            &read,
+                            &written);
+        }
+    } else {
+        uint8_t token = argNum - 2 - 2 * batch->recipientCount;
+        LEDGER_ASSERT(token < batch->tokenCount, "printBatchArgument Invalid argument");
+        if (batch->tokenCount == 1) {
+            strlcpy(label, "Total", sizeof(label));
+        } else {
+            snprintf(label, sizeof(label), "Total #%d", token + 1);
+        }
+        parseAssetField((uint8_t *) &batch->totals[token],
+                        sizeof(asset_t),
+                        label,
+                        arg,
+                        &read,
+                        &written);
+    }
 }
 
-static void processEosioVoteProducer(txProcessingContext_t *context) {
-    uint32_t bufferLength = context->currentActionDataBufferLength;
-    uint8_t *buffer = context->actionDataBuffer;
-
-    context->content->argumentCount = 1;
-    buffer += sizeof(name_t);
+void printArgument(uint8_t argNum, txProcessingContext_t *context) {
+    const actionDescriptor_t *descriptor = context->actionDescriptor;
+    actionArgument_t *arg = &context->content->arg;
 
-    name_t proxy = 0;
-    memmove(&proxy, buffer, sizeof(name_t));
-    if (proxy != 0) {
-        context->content->argumentCount++;
+    if (context->batchReview) {
+        printBatchArgument(argNum, context->batch, arg);
+        return;
+    }
+    if (descriptor != NULL) {
+        printActionArgument((const actionSchema_t *) PIC(descriptor->schema),
+                            context->actionDataBuffer,
+                            context->currentActionDataBufferLength,
+                            &context->argumentIndex,
+                            argNum,
+                            arg);
         return;
     }
-    buffer += sizeof(name_t);
-
-    uint32_t totalProducers = 0;
-    unpack_variant32(buffer, bufferLength, &totalProducers);
-    context->content->argumentCount += totalProducers;
-}
-
-static void processEosioUpdateAuth(txProcessingContext_t *context) {
-    uint32_t bufferLength = context->currentActionDataBufferLength;
-    uint8_t *buffer = context->actionDataBuffer;
-
-    context->content->argumentCount = 4;
-
-    uint32_t offset_update = 3 * sizeof(name_t) + sizeof(uint32_t);
-
-    LEDGER_ASSERT(offset_update < bufferLength, "processEosioUpdateAuth");
-    buffer += offset_update;
-    bufferLength -= offset_update;
-
-    uint32_t totalKeys = 0;
-    uint32_t read = unpack_variant32(buffer, bufferLength, &totalKeys);
-
-    LEDGER_ASSERT(read < bufferLength, "processEosioUpdateAuth");
-    buffer += read;
-    bufferLength -= read;
-
-    offset_update = 1 + sizeof(public_key_t) + sizeof(uint16_t);
-    LEDGER_ASSERT(!__builtin_mul_overflow(offset_update, totalKeys, &offset_update),
-                  "processEosioUpdateAuth");
-
-    LEDGER_ASSERT(offset_update < bufferLength, "processEosioUpdateAuth");
-    buffer += offset_update;
-    bufferLength -= offset_update;
-
-    LEDGER_ASSERT(!__builtin_add_overflow(totalKeys, totalKeys, &totalKeys),
-                  "processEosioUpdateAuth");  // totalKeys *= 2
-    LEDGER_ASSERT(!__builtin_add_overflow(context->content->argumentCount,
-                                          totalKeys,
-                                          &context->content->argumentCount),
-                  "processEosioUpdateAuth");
-
-    uint32_t totalAccounts = 0;
-    read = unpack_variant32(buffer, bufferLength, &totalAccounts);
-
-    // accounts data begins here
-    LEDGER_ASSERT(read < bufferLength, "processEosioUpdateAuth");
-    buffer += read;
-    bufferLength -= read;
-
-    offset_update = sizeof(permisssion_level_t) + sizeof(uint16_t);
-    LEDGER_ASSERT(!__builtin_mul_overflow(offset_update, totalAccounts, &offset_update),
-                  "processEosioUpdateAuth");
-
-    LEDGER_ASSERT(offset_update < bufferLength, "processEosioUpdateAuth");
-    buffer += offset_update;
-    bufferLength -= offset_update;
-
-    LEDGER_ASSERT(!__builtin_add_overflow(totalAccounts, totalAccounts, &totalAccounts),
-                  "processEosioUpdateAuth");  // totalAccounts *= 2
-    LEDGER_ASSERT(!__builtin_add_overflow(context->content->argumentCount,
-                                          totalAccounts,
-                                          &context->content->argumentCount),
-                  "processEosioUpdateAuth");
-
-    uint32_t totalWaits = 0;
-    unpack_variant32(buffer, bufferLength, &totalWaits);
-
-    LEDGER_ASSERT(!__builtin_add_overflow(totalWaits, totalWaits, &totalWaits),
-                  "processEosioUpdateAuth");  // totalWaits *= 2
-    LEDGER_ASSERT(!__builtin_add_overflow(context->content->argumentCount,
-                                          totalWaits,
-                                          &context->content->argumentCount),
-                  "processEosioUpdateAuth");
-}
-
-static void processEosioDeleteAuth(txProcessingContext_t *context) {
-    context->content->argumentCount = 2;
-}
-
-static void processEosioLinkAuth(txProcessingContext_t *context) {
-    context->content->argumentCount = 4;
-}
-
-static void processEosioUnlinkAuth(txProcessingContext_t *context) {
-    context->content->argumentCount = 3;
-}
 
-static void processUnknownAction(txProcessingContext_t *context) {
-    CX_ASSERT(cx_hash_no_throw(&context->dataSha256->header,
-                               CX_LAST,
-                               context->dataChecksum,
-                               0,
-                               context->dataChecksum,
-                               sizeof(context->dataChecksum)));
-    context->content->argumentCount = 3;
+    if (context->dataAllowed == 1) {
+        parseUnknownAction(context->dataChecksum, sizeof(context->dataChecksum), argNum, arg);
+    }
 }
 
-static void processEosioNewAccountAction(txProcessingContext_t *context) {
-    uint8_t *buffer = context->actionDataBuffer;
-    uint32_t bufferLength = context->currentActionDataBufferLength;
-
-    // Offset to auth structures: owner, active
-    buffer += 2 * sizeof(name_t);
-    bufferLength -= 2 * sizeof(name_t);
-
-    // Read owner key threshold
-    uint32_t threshold = 0;
-    memmove(&threshold, buffer, sizeof(threshold));
-    LEDGER_ASSERT(threshold == 1, "Owner Threshold should be 1");
-    buffer += sizeof(threshold);
-    bufferLength -= sizeof(threshold);
-
-    uint32_t size = 0;
-    uint32_t read = unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 1, "Owner key must be 1");
-    buffer += read;
-    bufferLength -= read;
-    // Offset to key weight
-    buffer += 1 + sizeof(public_key_t);
-    bufferLength -= 1 + sizeof(public_key_t);
-    uint16_t weight = 0;
-    memmove(&weight, buffer, sizeof(weight));
-    LEDGER_ASSERT(weight == 1, "Owner key weight must be 1");
-    buffer += sizeof(weight);
-    bufferLength -= sizeof(weight);
-
-    read = unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 0, "No accounts allowed");
-    buffer += read;
-    bufferLength -= read;
-    read = unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 0, "No delays allowed");
-    buffer += read;
-    bufferLength -= read;
-
-    // process Active authorization
-    // -----------------------------------
-
-    memmove(&threshold, buffer, sizeof(threshold));
-    LEDGER_ASSERT(threshold == 1, "Active Threshold should be 1");
-    buffer += sizeof(threshold);
-    bufferLength -= sizeof(threshold);
-
-    read = unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 1, "Active key must be 1");
-    buffer += read;
-    bufferLength -= read;
-    // Offset to key weight
-    buffer += 1 + sizeof(public_key_t);
-    bufferLength -= 1 + sizeof(public_key_t);
-    weight = 0;
-    memmove(&weight, buffer, sizeof(weight));
-    LEDGER_ASSERT(weight == 1, "Active key weight must be 1");
-    buffer += sizeof(weight);
-    bufferLength -= sizeof(weight);
-
-    read = unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 0, "No accounts allowed");
-    buffer += read;
-    bufferLength -= read;
-    unpack_variant32(buffer, bufferLength, &size);
-    LEDGER_ASSERT(size == 0, "No delays allowed");
-    context->content->argumentCount = 4;
+/**
+ * Append a string to the review cache arena.
+ * Return false if the arena is full.
+ */
+static bool appendReviewCacheString(reviewCache_t *cache,
+                                    uint32_t *arenaPos,
+                                    const char *string,
+                                    uint16_t *offset) {
+    uint32_t length = strlen(string) + 1;
+    if (length > REVIEW_CACHE_ARENA_SIZE - *arenaPos) {
+        return false;
+    }
+    memmove(cache->arena + *arenaPos, string, length);
+    *offset = *arenaPos;
+    *arenaPos += length;
+    return true;
 }
 
-void printArgument(uint8_t argNum, txProcessingContext_t *context) {
-    name_t contractName = context->contractName;
-    name_t actionName = context->contractActionName;
-    uint8_t *buffer = context->actionDataBuffer;
-    uint32_t bufferLength = context->currentActionDataBufferLength;
+/**
+ * Render all the arguments of the current action into the review cache.
+ * The cache is left empty if they do not fit.
+ */
+void fillReviewCache(txProcessingContext_t *context, reviewCache_t *cache) {
+    uint8_t argumentCount = context->content->argumentCount;
+    uint32_t arenaPos = 0;
     actionArgument_t *arg = &context->content->arg;
 
-    if (actionName == EOSIO_TOKEN_TRANSFER) {
-        parseTokenTransfer(buffer, bufferLength, argNum, arg);
+    cache->argumentCount = 0;
+    if (argumentCount > REVIEW_CACHE_MAX_ARGUMENTS) {
         return;
     }
 
-    if (contractName == EOSIO) {
-        switch (actionName) {
-            case EOSIO_DELEGATEBW:
-                parseDelegate(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_UNDELEGATEBW:
-                parseUndelegate(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_REFUND:
-                parseRefund(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_BUYRAM:
-                parseBuyRam(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_BUYRAMBYTES:
-                parseBuyRamBytes(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_SELLRAM:
-                parseSellRam(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_VOTEPRODUCER:
-                parseVoteProducer(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_UPDATE_AUTH:
-                parseUpdateAuth(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_DELETE_AUTH:
-                parseDeleteAuth(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_LINK_AUTH:
-                parseLinkAuth(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_UNLINK_AUTH:
-                parseUnlinkAuth(buffer, bufferLength, argNum, arg);
-                break;
-            case EOSIO_NEW_ACCOUNT:
-                parseNewAccount(buffer, bufferLength, argNum, arg);
-                break;
-            default:
-                if (context->dataAllowed == 1) {
-                    parseUnknownAction(context->dataChecksum,
-                                       sizeof(context->dataChecksum),
-                                       argNum,
-                                       arg);
-                }
+    for (uint8_t i = 0; i < argumentCount; i++) {
+        printArgument(i, context);
+        if (!appendReviewCacheString(cache, &arenaPos, arg->label, &cache->labelOffset[i]) ||
+            !appendReviewCacheString(cache, &arenaPos, arg->data, &cache->dataOffset[i])) {
+            return;
         }
-        return;
     }
+    cache->argumentCount = argumentCount;
+}
 
-    if (context->dataAllowed == 1) {
-        parseUnknownAction(context->dataChecksum, sizeof(context->dataChecksum), argNum, arg);
+/**
+ * Look up a rendered argument in the review cache.
+ * Return false if it is not cached, the caller must then use printArgument().
+ */
+bool getReviewCacheArgument(const reviewCache_t *cache,
+                            uint8_t argNum,
+                            const char **label,
+                            const char **data) {
+    if (argNum >= cache->argumentCount) {
+        return false;
     }
+    *label = cache->arena + cache->labelOffset[argNum];
+    *data = cache->arena + cache->dataOffset[argNum];
+    return true;
 }
 
-static bool isKnownAction(txProcessingContext_t *context) {
-    name_t contractName = context->contractName;
-    name_t actionName = context->contractActionName;
-    if (actionName == EOSIO_TOKEN_TRANSFER) {
-        return true;
-    }
-
-    if (contractName == EOSIO) {
-        switch (actionName) {
-            case EOSIO_DELEGATEBW:
-            case EOSIO_UNDELEGATEBW:
-            case EOSIO_REFUND:
-            case EOSIO_BUYRAM:
-            case EOSIO_BUYRAMBYTES:
-            case EOSIO_SELLRAM:
-            case EOSIO_VOTEPRODUCER:
-            case EOSIO_UPDATE_AUTH:
-            case EOSIO_DELETE_AUTH:
-            case EOSIO_LINK_AUTH:
-            case EOSIO_UNLINK_AUTH:
-            case EOSIO_NEW_ACCOUNT:
-                return true;
-        }
+/**
+ * Record a span of the work buffer to be hashed.
+ *
+ * Field values are not fed to the digests one by one. They are recorded as a single
+ * span of the work buffer and hashed at once when the span is flushed. Values of
+ * consecutive fields are separated by their TLV headers, which are already consumed
+ * at this point, so the value is moved back over that gap to keep the span contiguous.
+ * Callers must be done reading the value before recording it.
+ */
+static void recordHashSpan(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
+    if (context->hashSpanLength == 0) {
+        context->hashSpan = buffer;
+    } else if (context->hashSpan + context->hashSpanLength != buffer) {
+        LEDGER_ASSERT(context->hashSpan + context->hashSpanLength < buffer, "recordHashSpan");
+        memmove(context->hashSpan + context->hashSpanLength, buffer, length);
+    }
+    context->hashSpanLength += length;
+}
+
+/**
+ * Feed the action data part of the recorded span to the action checksum.
+ * Action data is always the tail of the span, see hashTxAndActionData().
+ */
+static void flushActionDataHash(txProcessingContext_t *context) {
+    if (context->dataHashSpanLength != 0) {
+        CX_ASSERT(cx_hash_no_throw(
+            &context->dataSha256->header,
+            0,
+            context->hashSpan + context->hashSpanLength - context->dataHashSpanLength,
+            context->dataHashSpanLength,
+            NULL,
+            0));
+        context->dataHashSpanLength = 0;
+    }
+}
+
+/**
+ * Feed the recorded span to the digests. Must be called before the work buffer
+ * is released, that is every time the parser returns.
+ */
+static void flushTxHash(txProcessingContext_t *context) {
+    flushActionDataHash(context);
+    if (context->hashSpanLength != 0) {
+        CX_ASSERT(cx_hash_no_throw(&context->sha256->header,
+                                   0,
+                                   context->hashSpan,
+                                   context->hashSpanLength,
+                                   NULL,
+                                   0));
+        context->hashSpanLength = 0;
     }
-    return false;
 }
 
 /**
@@ -386,331 +321,489 @@ static bool isKnownAction(txProcessingContext_t *context) {
  * dependencies on specific hash implementation.
  */
 static void hashTxData(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
-    CX_ASSERT(cx_hash_no_throw(&context->sha256->header, 0, buffer, length, NULL, 0));
+    // Pending action data must stay at the tail of the span
+    flushActionDataHash(context);
+    recordHashSpan(context, buffer, length);
 }
 
-static void hashActionData(txProcessingContext_t *context, uint8_t *buffer, uint32_t length) {
-    CX_ASSERT(cx_hash_no_throw(&context->dataSha256->header, 0, buffer, length, NULL, 0));
+/**
+ * Hash an incoming data into both the transaction digest and the action checksum.
+ * The data is recorded once, the action checksum covers the last
+ * dataHashSpanLength bytes of the span.
+ */
+static void hashTxAndActionData(txProcessingContext_t *context,
+                                uint8_t *buffer,
+                                uint32_t length) {
+    recordHashSpan(context, buffer, length);
+    context->dataHashSpanLength += length;
 }
 
 /**
- * Process all fields that do not require any processing except hashing.
- * The data comes in by chucks, so it may happen that buffer may contain
- * incomplete data for particular field. Function designed to process
- * everything until it receives all data for a particular field
- * and after that will move to next field.
+ * Zero size field completion: check the decoded list size.
+ * Throw exception if number is not '0'.
  */
-static void processField(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
+static void completeZeroSizeField(txProcessingContext_t *context) {
+    LEDGER_ASSERT(context->varuint.value == 0, "processCtxFreeAction Action Number must be 0");
 
-        LEDGER_ASSERT(length <= context->commandLength, "processField");
-        hashTxData(context, context->workBuffer, length);
+    // Move to next state
+    context->state++;
+}
 
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+/**
+ * Action Number Field completion: read actual number of actions encoded in buffer.
+ */
+static void completeActionListSizeField(txProcessingContext_t *context) {
+    context->currentActionNumber = context->varuint.value;
+    context->currentActionIndex = 0;
+
+    context->state++;
+    // A transaction of a batch without action would be signed without any row of the
+    // review
+    if (context->currentActionNumber == 0 && context->batch != NULL) {
+        PRINTF("Batch transaction without action\n");
+        context->actionRejected = true;
     }
-
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->state++;
-        context->processingField = false;
+    if (context->currentActionNumber > 1 && context->reviewQueue == NULL &&
+        context->batch == NULL) {
+        context->confirmProcessing = true;
     }
 }
 
 /**
- * Process Size fields that are expected to have Zero value. Except hashing the data, function
- * caches an incommng data. So, when all bytes for particular field are received
- * do additional processing: Read actual number of actions encoded in buffer.
- * Throw exception if number is not '0'.
+ * Action Account Field completion: cache the contract name in order to
+ * display it for validation.
  */
-static void processZeroSizeField(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processZeroSizeField");
-        hashTxData(context, context->workBuffer, length);
+static void completeActionAccount(txProcessingContext_t *context) {
+    context->state++;
 
-        // Store data into a buffer
-        LEDGER_ASSERT(length <= sizeof(context->sizeBuffer) - context->currentFieldPos,
-                      "processZeroSizeField");
-        memmove(context->sizeBuffer + context->currentFieldPos, context->workBuffer, length);
+    memset(context->content->contract, 0, sizeof(context->content->contract));
+    name_to_string(context->contractName,
+                   context->content->contract,
+                   sizeof(context->content->contract));
+}
 
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+/**
+ * Action Name Field completion: cache the action name in order to
+ * display it for validation.
+ */
+static void completeActionName(txProcessingContext_t *context) {
+    context->state++;
+
+    memset(context->content->action, 0, sizeof(context->content->action));
+    name_to_string(context->contractActionName,
+                   context->content->action,
+                   sizeof(context->content->action));
+
+    context->actionDescriptor = findAction(context->contractName, context->contractActionName);
+    if (context->actionDescriptor != NULL) {
+        memset(&context->argumentIndex, 0, sizeof(context->argumentIndex));
+        initActionDecoder(&context->actionDecoder,
+                          (const actionSchema_t *) PIC(context->actionDescriptor->schema));
     }
+}
 
-    if (context->currentFieldPos == context->currentFieldLength) {
-        uint32_t sizeValue = 0;
-        unpack_variant32(context->sizeBuffer, context->currentFieldPos + 1, &sizeValue);
-        LEDGER_ASSERT(sizeValue == 0, "processCtxFreeAction Action Number must be 0");
-        // Reset size buffer
-        memset(context->sizeBuffer, 0, sizeof(context->sizeBuffer));
-
-        // Move to next state
+/**
+ * Authorization Number Field completion: initialize context authorization
+ * index and number.
+ */
+static void completeAuthorizationListSizeField(txProcessingContext_t *context) {
+    context->currentAutorizationNumber = context->varuint.value;
+    context->currentAutorizationIndex = 0;
+
+    // Move to next state, there is no authorization field to read for an empty list
+    if (context->currentAutorizationNumber == 0) {
+        context->state = TLV_ACTION_DATA_SIZE;
+    } else {
         context->state++;
-        context->processingField = false;
     }
 }
 
 /**
- * Process Action Number Field. Except hashing the data, function
- * caches an incoming data. So, when all bytes for particular field are received
- * do additional processing: Read actual number of actions encoded in buffer.
+ * Authorization Permission Field completion: start over authorization
+ * processing if the there is data for that.
  */
-static void processActionListSizeField(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processActionListSizeField");
-        hashTxData(context, context->workBuffer, length);
-
-        // Store data into a buffer
-        LEDGER_ASSERT(length <= sizeof(context->sizeBuffer) - context->currentFieldPos,
-                      "processActionListSizeField");
-        memmove(context->sizeBuffer + context->currentFieldPos, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
-    }
-
-    if (context->currentFieldPos == context->currentFieldLength) {
-        unpack_variant32(context->sizeBuffer,
-                         context->currentFieldPos + 1,
-                         &context->currentActionNumber);
-        context->currentActionIndex = 0;
-
-        // Reset size buffer
-        memset(context->sizeBuffer, 0, sizeof(context->sizeBuffer));
-
+static void completeAuthorizationPermission(txProcessingContext_t *context) {
+    context->currentAutorizationIndex++;
+
+    // Start over reading Authorization data or move to the next state
+    // if all authorization data have been read
+    if (context->currentAutorizationIndex != context->currentAutorizationNumber) {
+        context->state = TLV_AUTHORIZATION_ACTOR;
+    } else {
         context->state++;
-        context->processingField = false;
-        if (context->currentActionNumber > 1) {
-            context->confirmProcessing = true;
-        }
     }
 }
 
 /**
- * Process Action Account Field. Cache a data of the field in order to
- * display it for validation.
+ * Header of an action in the review queue.
  */
-static void processActionAccount(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processActionAccount");
-        hashTxData(context, context->workBuffer, length);
-
-        uint8_t *pContract = (uint8_t *) &context->contractName;
+typedef struct reviewQueueEntry_t {
+    name_t contractName;
+    name_t actionName;
+    const actionDescriptor_t *descriptor;
+    actionArgumentIndex_t argumentIndex;
+    uint16_t dataLength;
+    uint8_t argumentCount;
+} reviewQueueEntry_t;
 
-        LEDGER_ASSERT(length <= sizeof(context->sizeBuffer) - context->currentFieldPos,
-                      "processActionAccount");
-        memmove(pContract + context->currentFieldPos, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+/**
+ * Append the current action to the review queue: what its review needs, that is
+ * the argument store of a known action, or the checksum of an unknown action.
+ * Return false if the queue is full.
+ */
+static bool queueAction(txProcessingContext_t *context) {
+    reviewQueue_t *queue = context->reviewQueue;
+    reviewQueueEntry_t entry;
+    const uint8_t *data = context->dataChecksum;
+
+    entry.contractName = context->contractName;
+    entry.actionName = context->contractActionName;
+    entry.descriptor = context->actionDescriptor;
+    entry.argumentIndex = context->argumentIndex;
+    entry.dataLength = sizeof(context->dataChecksum);
+    entry.argumentCount = context->content->argumentCount;
+    if (entry.descriptor != NULL) {
+        data = context->actionDataBuffer;
+        entry.dataLength = context->currentActionDataBufferLength;
     }
 
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->state++;
-        context->processingField = false;
-
-        memset(context->content->contract, 0, sizeof(context->content->contract));
-        name_to_string(context->contractName,
-                       context->content->contract,
-                       sizeof(context->content->contract));
+    if ((uint32_t) sizeof(entry) + entry.dataLength >
+        (uint32_t) (REVIEW_QUEUE_SIZE - queue->length)) {
+        PRINTF("Review queue full\n");
+        return false;
     }
+    // Entries are not aligned
+    memmove(queue->buffer + queue->length, &entry, sizeof(entry));
+    queue->length += sizeof(entry);
+    memmove(queue->buffer + queue->length, data, entry.dataLength);
+    queue->length += entry.dataLength;
+    return true;
+}
+
+void startQueuedReview(txProcessingContext_t *context) {
+    context->currentActionIndex = 0;
+    context->reviewQueue->readPos = 0;
 }
 
 /**
- * Process Action Name Field. Cache a data of the field in order to
- * display it for validation.
+ * Restore the next queued action into the context, as if it has just been parsed.
+ * Return STREAM_ACTION_READY, or STREAM_FINISHED once all actions are reviewed.
  */
-static void processActionName(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
+parserStatus_e reviewNextQueuedAction(txProcessingContext_t *context) {
+    reviewQueue_t *queue = context->reviewQueue;
+    reviewQueueEntry_t entry;
 
-        LEDGER_ASSERT(length <= context->commandLength, "processActionName");
-        hashTxData(context, context->workBuffer, length);
-
-        uint8_t *pAction = (uint8_t *) &context->contractActionName;
-        LEDGER_ASSERT(length <= sizeof(context->sizeBuffer) - context->currentFieldPos,
-                      "processActionName");
-        memmove(pAction + context->currentFieldPos, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+    if (context->currentActionIndex == context->currentActionNumber) {
+        return STREAM_FINISHED;
     }
-
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->state++;
-        context->processingField = false;
-
-        memset(context->content->action, 0, sizeof(context->content->action));
-        name_to_string(context->contractActionName,
-                       context->content->action,
-                       sizeof(context->content->action));
+    LEDGER_ASSERT((uint32_t) sizeof(entry) <= (uint32_t) (queue->length - queue->readPos),
+                  "reviewNextQueuedAction");
+    memmove(&entry, queue->buffer + queue->readPos, sizeof(entry));
+    queue->readPos += sizeof(entry);
+
+    context->contractName = entry.contractName;
+    context->contractActionName = entry.actionName;
+    context->actionDescriptor = entry.descriptor;
+    memset(context->content->contract, 0, sizeof(context->content->contract));
+    name_to_string(entry.contractName,
+                   context->content->contract,
+                   sizeof(context->content->contract));
+    memset(context->content->action, 0, sizeof(context->content->action));
+    name_to_string(entry.actionName, context->content->action, sizeof(context->content->action));
+    context->argumentIndex = entry.argumentIndex;
+    context->currentActionDataBufferLength = entry.dataLength;
+    context->content->argumentCount = entry.argumentCount;
+    if (entry.descriptor != NULL) {
+        memmove(context->actionDataBuffer, queue->buffer + queue->readPos, entry.dataLength);
+    } else {
+        memmove(context->dataChecksum, queue->buffer + queue->readPos, entry.dataLength);
     }
+    queue->readPos += entry.dataLength;
+    context->currentActionIndex++;
+    return STREAM_ACTION_READY;
 }
 
 /**
- * Process Authorization Number Field. Initialize context action number
- * index and context action number.
+ * Add an amount to the asset of the same symbol in a list, or append it to the list.
+ * Return false if the list is full or if the sum overflows.
  */
-static void processAuthorizationListSizeField(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processAuthorizationListSizeField");
-        hashTxData(context, context->workBuffer, length);
-
-        // Store data into a buffer
-        LEDGER_ASSERT(length <= sizeof(context->sizeBuffer) - context->currentFieldPos,
-                      "processAuthorizationListSizeField");
-        memmove(context->sizeBuffer + context->currentFieldPos, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+static bool addBatchAmount(asset_t *assets,
+                           name_t *names,
+                           name_t name,
+                           uint8_t *count,
+                           uint8_t maxCount,
+                           const asset_t *amount) {
+    uint8_t i;
+
+    for (i = 0; i < *count; i++) {
+        if (assets[i].symbol == amount->symbol && (names == NULL || names[i] == name)) {
+            break;
+        }
     }
-
-    if (context->currentFieldPos == context->currentFieldLength) {
-        unpack_variant32(context->sizeBuffer,
-                         context->currentFieldPos + 1,
-                         &context->currentAutorizationNumber);
-        context->currentAutorizationIndex = 0;
-        // Reset size buffer
-        memset(context->sizeBuffer, 0, sizeof(context->sizeBuffer));
-
-        // Move to next state
-        context->state++;
-        context->processingField = false;
+    if (i == *count) {
+        if (*count == maxCount) {
+            PRINTF("Too many batch amounts\n");
+            return false;
+        }
+        assets[i].amount = 0;
+        assets[i].symbol = amount->symbol;
+        if (names != NULL) {
+            names[i] = name;
+        }
+        (*count)++;
+    }
+    if (assets[i].amount > INT64_MAX - amount->amount) {
+        PRINTF("Batch amount overflow\n");
+        return false;
     }
+    assets[i].amount += amount->amount;
+    return true;
 }
 
 /**
- * Process Authorization Permission Field. When the field is processed
- * start over authorization processing if the there is data for that.
+ * Sum the current action into the batch summary, it must be a transfer of the batch
+ * token contract from the batch sender, without memo. Return false otherwise.
  */
-static void processAuthorizationPermission(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processAuthorizationPermission");
-        hashTxData(context, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+static bool addBatchTransfer(txProcessingContext_t *context) {
+    batchSummary_t *batch = context->batch;
+    name_t from;
+    name_t to;
+    asset_t quantity;
+
+    if (context->actionDescriptor == NULL ||
+        context->contractActionName != EOSIO_TOKEN_TRANSFER) {
+        PRINTF("Batch action is not a transfer\n");
+        return false;
+    }
+    // Argument store of a transfer: from, to, quantity and memo
+    memmove(&from, context->actionDataBuffer, sizeof(from));
+    memmove(&to, context->actionDataBuffer + sizeof(name_t), sizeof(to));
+    memmove(&quantity, context->actionDataBuffer + 2 * sizeof(name_t), sizeof(quantity));
+    if (context->argumentIndex.listSize[0] != 0 || quantity.amount <= 0) {
+        PRINTF("Batch transfer with memo or invalid quantity\n");
+        return false;
     }
 
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->currentAutorizationIndex++;
-        // Reset size buffer
-        memset(context->sizeBuffer, 0, sizeof(context->sizeBuffer));
-
-        // Start over reading Authorization data or move to the next state
-        // if all authorization data have been read
-        if (context->currentAutorizationIndex != context->currentAutorizationNumber) {
-            context->state = TLV_AUTHORIZATION_ACTOR;
-        } else {
-            context->state++;
-        }
-        context->processingField = false;
+    if (batch->recipientCount == 0) {
+        batch->contract = context->contractName;
+        batch->from = from;
     }
+    if (batch->contract != context->contractName || batch->from != from) {
+        PRINTF("Batch transfer of another contract or sender\n");
+        return false;
+    }
+    return addBatchAmount(batch->amounts,
+                          batch->recipients,
+                          to,
+                          &batch->recipientCount,
+                          BATCH_MAX_RECIPIENTS,
+                          &quantity) &&
+           addBatchAmount(batch->totals, NULL, 0, &batch->tokenCount, BATCH_MAX_TOKENS, &quantity);
 }
 
-static void processUnknownActionDataSize(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
+/**
+ * Display the batch summary as a single action to review. Return false if the batch
+ * holds no transfer.
+ */
+bool startBatchReview(txProcessingContext_t *context) {
+    batchSummary_t *batch = context->batch;
 
-        LEDGER_ASSERT(length <= context->commandLength, "processUnknownActionDataSize");
-        hashTxData(context, context->workBuffer, length);
-        hashActionData(context, context->workBuffer, length);
+    if (batch->recipientCount == 0) {
+        PRINTF("Empty batch\n");
+        return false;
+    }
+    context->batchReview = true;
+    context->currentActionIndex = 1;
+    context->currentActionNumber = 1;
+    memset(context->content->contract, 0, sizeof(context->content->contract));
+    name_to_string(batch->contract,
+                   context->content->contract,
+                   sizeof(context->content->contract));
+    memset(context->content->action, 0, sizeof(context->content->action));
+    name_to_string(EOSIO_TOKEN_TRANSFER,
+                   context->content->action,
+                   sizeof(context->content->action));
+    context->content->argumentCount = 2 + 2 * batch->recipientCount + batch->tokenCount;
+    return true;
+}
 
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+/**
+ * Action data completion: count the decoded arguments to display, or finalize the
+ * checksum of an unknown action, then move to the next action.
+ */
+static void completeActionData(txProcessingContext_t *context) {
+    if (context->actionDescriptor == NULL) {
+        flushActionDataHash(context);
+        processUnknownAction(context);
+        cx_sha256_init(context->dataSha256);
+    } else {
+        LEDGER_ASSERT(context->actionDecoder.done, "completeActionData Incomplete action data");
+        context->currentActionDataBufferLength = context->actionDecoder.storeLength;
+        uint32_t argumentCount =
+            countActionArguments((const actionSchema_t *) PIC(context->actionDescriptor->schema),
+                                 context->actionDataBuffer,
+                                 context->currentActionDataBufferLength,
+                                 &context->argumentIndex);
+        LEDGER_ASSERT(argumentCount <= INT8_MAX, "completeActionData Too many arguments");
+        context->content->argumentCount = argumentCount;
     }
 
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->state++;
-        context->processingField = false;
+    if (++context->currentActionIndex < context->currentActionNumber) {
+        context->state = TLV_ACTION_ACCOUNT;
+    } else {
+        context->state = TLV_TX_EXTENSION_LIST_SIZE;
+    }
+
+    // An action the batch does not accept, or that does not fit in the review queue,
+    // fails the parsing
+    if (context->batch != NULL) {
+        context->actionRejected = !addBatchTransfer(context);
+    } else if (context->reviewQueue != NULL) {
+        context->actionRejected = !queueAction(context);
+    } else {
+        context->actionReady = true;
     }
 }
 
 /**
- * Process current unknown action data field and calculate checksum.
+ * Where the value of a field goes, besides the transaction digest.
  */
-static void processUnknownActionData(txProcessingContext_t *context) {
-    if (context->currentFieldPos < context->currentFieldLength) {
-        uint32_t length =
-            (context->commandLength < ((context->currentFieldLength - context->currentFieldPos))
-                 ? context->commandLength
-                 : context->currentFieldLength - context->currentFieldPos);
-
-        LEDGER_ASSERT(length <= context->commandLength, "processUnknownActionData");
-        hashTxData(context, context->workBuffer, length);
-        hashActionData(context, context->workBuffer, length);
-
-        context->workBuffer += length;
-        context->commandLength -= length;
-        context->currentFieldPos += length;
+typedef enum txFieldSink_e {
+    // Hash only
+    SINK_HASH,
+    // Cache the value into the context at sinkOffset
+    SINK_CAPTURE,
+    // Decode the varuint32 value into the context
+    SINK_VARUINT,
+    // Hash into both the transaction digest and the action checksum
+    SINK_CHECKSUM,
+    // Hash only for known actions, checksum for unknown actions
+    SINK_ACTION_DATA_SIZE,
+    // Decode for known actions, checksum for unknown actions
+    SINK_ACTION_DATA,
+    // Decode along the action schema into the argument store
+    SINK_DECODE,
+} txFieldSink_e;
+
+typedef void (*txFieldCompletion_t)(txProcessingContext_t *context);
+
+// Packed field lengths that are not fixed
+#define PACKED_VARUINT     0xFF  // varuint32, length is known once the last byte is read
+#define PACKED_DATA_LENGTH 0xFE  // length given by the preceding varuint32
+
+typedef struct txFieldDescriptor_t {
+    uint8_t sink;
+    // Length of the field in packed encoding
+    uint8_t packedLength;
+    uint16_t sinkOffset;
+    uint16_t sinkSize;
+    // Called once all bytes of the field are processed, moves to the next state if NULL
+    txFieldCompletion_t complete;
+} txFieldDescriptor_t;
+
+#define FIELD_SIZE(member) sizeof(((txProcessingContext_t *) 0)->member)
+#define FIELD_HASH(packedLength, complete) \
+    { SINK_HASH, packedLength, 0, 0, complete }
+#define FIELD_VARUINT(complete) \
+    { SINK_VARUINT, PACKED_VARUINT, 0, 0, complete }
+#define FIELD_CAPTURE(member, packedLength, complete)                                     \
+    {                                                                                    \
+        SINK_CAPTURE, packedLength, offsetof(txProcessingContext_t, member),             \
+            FIELD_SIZE(member), complete                                                 \
     }
 
-    if (context->currentFieldPos == context->currentFieldLength) {
-        context->currentActionDataBufferLength = context->currentFieldLength;
+/**
+ * Field descriptors indexed by txProcessingState_e. This is the single place to
+ * describe how the value of a field is consumed and where the parser goes next.
+ */
+static const txFieldDescriptor_t TX_FIELDS[TLV_DONE] = {
+    [TLV_CHAIN_ID] = FIELD_HASH(32, NULL),
+    [TLV_HEADER_EXPITATION] = FIELD_HASH(sizeof(uint32_t), NULL),
+    [TLV_HEADER_REF_BLOCK_NUM] = FIELD_HASH(sizeof(uint16_t), NULL),
+    [TLV_HEADER_REF_BLOCK_PREFIX] = FIELD_HASH(sizeof(uint32_t), NULL),
+    [TLV_HEADER_MAX_NET_USAGE_WORDS] = FIELD_HASH(PACKED_VARUINT, NULL),
+    [TLV_HEADER_MAX_CPU_USAGE_MS] = FIELD_HASH(sizeof(uint8_t), NULL),
+    [TLV_HEADER_DELAY_SEC] = FIELD_HASH(PACKED_VARUINT, NULL),
+    [TLV_CFA_LIST_SIZE] = FIELD_VARUINT(completeZeroSizeField),
+    [TLV_ACTION_LIST_SIZE] = FIELD_VARUINT(completeActionListSizeField),
+    [TLV_ACTION_ACCOUNT] = FIELD_CAPTURE(contractName, sizeof(name_t), completeActionAccount),
+    [TLV_ACTION_NAME] = FIELD_CAPTURE(contractActionName, sizeof(name_t), completeActionName),
+    [TLV_AUTHORIZATION_LIST_SIZE] = FIELD_VARUINT(completeAuthorizationListSizeField),
+    [TLV_AUTHORIZATION_ACTOR] = FIELD_HASH(sizeof(name_t), NULL),
+    [TLV_AUTHORIZATION_PERMISSION] = FIELD_HASH(sizeof(name_t), completeAuthorizationPermission),
+    [TLV_ACTION_DATA_SIZE] = {SINK_ACTION_DATA_SIZE, PACKED_VARUINT, 0, 0, NULL},
+    [TLV_ACTION_DATA] = {SINK_ACTION_DATA, PACKED_DATA_LENGTH, 0, 0, completeActionData},
+    [TLV_TX_EXTENSION_LIST_SIZE] = FIELD_VARUINT(completeZeroSizeField),
+    [TLV_CONTEXT_FREE_DATA] = FIELD_HASH(sizeof(checksum256), NULL),
+};
 
-        processUnknownAction(context);
+/**
+ * Start a field of a packed transaction. There is no header, the length of the
+ * field is derived from its descriptor.
+ */
+static void startPackedField(txProcessingContext_t *context) {
+    const txFieldDescriptor_t *field = &TX_FIELDS[context->state];
+
+    if (field->packedLength == PACKED_VARUINT) {
+        // Grown by one byte for each byte having the continuation bit set
+        context->currentFieldLength = 1;
+    } else if (field->packedLength == PACKED_DATA_LENGTH) {
+        context->currentFieldLength = context->varuint.value;
+    } else {
+        context->currentFieldLength = field->packedLength;
+    }
+    context->currentFieldPos = 0;
+    context->processingField = true;
+}
 
-        if (++context->currentActionIndex < context->currentActionNumber) {
-            context->state = TLV_ACTION_ACCOUNT;
-        } else {
-            context->state = TLV_TX_EXTENSION_LIST_SIZE;
+/**
+ * Decode bytes of a varuint32 field. A packed field is extended by one byte while the
+ * continuation bit is set, the length of a TLV field must match the encoding.
+ */
+static void processVaruintBytes(txProcessingContext_t *context,
+                                const uint8_t *buffer,
+                                uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        varuint32_status_e status = varuint32_decode_byte(&context->varuint, buffer[i]);
+        LEDGER_ASSERT(status != VARUINT32_INVALID, "processVaruintBytes Invalid varuint32");
+        if (status == VARUINT32_PENDING && context->packed) {
+            context->currentFieldLength++;
         }
-
-        context->processingField = false;
-        context->actionReady = true;
-
-        cx_sha256_init(context->dataSha256);
     }
 }
 
 /**
- * Process current action data field and store in into data buffer.
+ * Process the value of the current field as described by its descriptor.
+ * The data comes in by chucks, so it may happen that buffer may contain
+ * incomplete data for particular field. Function designed to process
+ * everything until it receives all data for a particular field
+ * and after that will move to next field.
  */
-static void processActionData(txProcessingContext_t *context) {
-    LEDGER_ASSERT(context->currentFieldLength <= sizeof(context->actionDataBuffer) - 1,
-                  "processActionData data overflow");
+static bool processField(txProcessingContext_t *context) {
+    const txFieldDescriptor_t *field = &TX_FIELDS[context->state];
+    uint8_t sink = field->sink;
+    // Varuint32 values are needed to walk a packed transaction, and for list sizes
+    bool varuint = field->sink == SINK_VARUINT ||
+                   (context->packed && field->packedLength == PACKED_VARUINT);
+
+    if (sink == SINK_ACTION_DATA_SIZE || sink == SINK_ACTION_DATA) {
+        if (context->actionDescriptor != NULL) {
+            sink = (sink == SINK_ACTION_DATA ? SINK_DECODE : SINK_HASH);
+        } else if (context->dataAllowed == 1) {
+            sink = SINK_CHECKSUM;
+        } else if (sink == SINK_ACTION_DATA) {
+            PRINTF("UNKNOWN ACTION");
+            return false;
+        } else {
+            sink = SINK_HASH;
+        }
+    }
+    if (sink == SINK_CAPTURE) {
+        LEDGER_ASSERT(context->currentFieldLength <= field->sinkSize, "processField overflow");
+    }
+    if (varuint && context->currentFieldPos == 0) {
+        varuint32_decoder_init(&context->varuint);
+    }
 
     if (context->currentFieldPos < context->currentFieldLength) {
         uint32_t length =
@@ -718,8 +811,31 @@ static void processActionData(txProcessingContext_t *context) {
                  ? context->commandLength
                  : context->currentFieldLength - context->currentFieldPos);
 
-        hashTxData(context, context->workBuffer, length);
-        memmove(context->actionDataBuffer + context->currentFieldPos, context->workBuffer, length);
+        LEDGER_ASSERT(length <= context->commandLength, "processField");
+        if (varuint) {
+            processVaruintBytes(context, context->workBuffer, length);
+        }
+        if (sink == SINK_CAPTURE) {
+            uint8_t *target = (uint8_t *) context + field->sinkOffset;
+            memmove(target + context->currentFieldPos, context->workBuffer, length);
+            hashTxData(context, context->workBuffer, length);
+        } else if (sink == SINK_DECODE) {
+            // Fields too large to be displayed make the action rejected
+            if (!decodeActionData(&context->actionDecoder,
+                                  (const actionSchema_t *) PIC(context->actionDescriptor->schema),
+                                  &context->argumentIndex,
+                                  context->actionDataBuffer,
+                                  sizeof(context->actionDataBuffer),
+                                  context->workBuffer,
+                                  length)) {
+                return false;
+            }
+            hashTxData(context, context->workBuffer, length);
+        } else if (sink == SINK_CHECKSUM) {
+            hashTxAndActionData(context, context->workBuffer, length);
+        } else {
+            hashTxData(context, context->workBuffer, length);
+        }
 
         context->workBuffer += length;
         context->commandLength -= length;
@@ -727,64 +843,23 @@ static void processActionData(txProcessingContext_t *context) {
     }
 
     if (context->currentFieldPos == context->currentFieldLength) {
-        context->currentActionDataBufferLength = context->currentFieldLength;
-
-        if (context->contractActionName == EOSIO_TOKEN_TRANSFER) {
-            processTokenTransfer(context);
-        } else if (context->contractName == EOSIO) {
-            switch (context->contractActionName) {
-                case EOSIO_DELEGATEBW:
-                    processEosioDelegate(context);
-                    break;
-                case EOSIO_UNDELEGATEBW:
-                    processEosioUndelegate(context);
-                    break;
-                case EOSIO_REFUND:
-                    processEosioRefund(context);
-                    break;
-                case EOSIO_VOTEPRODUCER:
-                    processEosioVoteProducer(context);
-                    break;
-                case EOSIO_BUYRAM:
-                case EOSIO_BUYRAMBYTES:
-                    processEosioBuyRam(context);
-                    break;
-                case EOSIO_SELLRAM:
-                    processEosioSellRam(context);
-                    break;
-                case EOSIO_UPDATE_AUTH:
-                    processEosioUpdateAuth(context);
-                    break;
-                case EOSIO_DELETE_AUTH:
-                    processEosioDeleteAuth(context);
-                    break;
-                case EOSIO_LINK_AUTH:
-                    processEosioLinkAuth(context);
-                    break;
-                case EOSIO_UNLINK_AUTH:
-                    processEosioUnlinkAuth(context);
-                    break;
-                case EOSIO_NEW_ACCOUNT:
-                    processEosioNewAccountAction(context);
-                    break;
-                default:
-                    LEDGER_ASSERT(false, "processActionData");
-            }
-        }
-
-        if (++context->currentActionIndex < context->currentActionNumber) {
-            context->state = TLV_ACTION_ACCOUNT;
+        txFieldCompletion_t complete = (txFieldCompletion_t) PIC(field->complete);
+        LEDGER_ASSERT(!varuint || context->varuint.done, "processField Truncated varuint32");
+        if (complete != NULL) {
+            complete(context);
         } else {
-            context->state = TLV_TX_EXTENSION_LIST_SIZE;
+            context->state++;
         }
-
         context->processingField = false;
-        context->actionReady = true;
     }
+    return true;
 }
 
 static parserStatus_e processTxInternal(txProcessingContext_t *context) {
     for (;;) {
+        if (context->actionRejected) {
+            return STREAM_FAULT;
+        }
         if (context->confirmProcessing) {
             context->confirmProcessing = false;
             return STREAM_CONFIRM_PROCESSING;
@@ -799,10 +874,37 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
         if (context->commandLength == 0) {
             return STREAM_PROCESSING;
         }
+        if ((context->state < TLV_CHAIN_ID) || (context->state >= TLV_DONE)) {
+            PRINTF("Invalid TLV decoder context\n");
+            return STREAM_FAULT;
+        }
+        if (!context->processingField && context->packed) {
+            startPackedField(context);
+        }
         if (!context->processingField) {
             // While we are not processing a field, we should TLV parameters
             bool decoded = false;
-            while (context->commandLength != 0) {
+            uint32_t headerLength = 0;
+            if (context->tlvBufferPos == 0) {
+                bool valid;
+                // Fast path: the whole header is usually in the current chunk,
+                // decode it in place
+                decoded = tlvTryDecode(context->workBuffer,
+                                       context->commandLength,
+                                       &context->currentFieldLength,
+                                       &headerLength,
+                                       &valid);
+                if (!valid) {
+                    PRINTF("TLV decoding error\n");
+                    return STREAM_FAULT;
+                }
+                if (decoded) {
+                    context->workBuffer += headerLength;
+                    context->commandLength -= headerLength;
+                }
+            }
+            // Otherwise the header is split across chunks, buffer it byte by byte
+            while (!decoded && context->commandLength != 0) {
                 bool valid;
                 // Feed the TLV buffer until the length can be decoded
                 context->tlvBuffer[context->tlvBufferPos++] = readTxByte(context);
@@ -810,6 +912,7 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
                 decoded = tlvTryDecode(context->tlvBuffer,
                                        context->tlvBufferPos,
                                        &context->currentFieldLength,
+                                       &headerLength,
                                        &valid);
 
                 if (!valid) {
@@ -834,75 +937,8 @@ static parserStatus_e processTxInternal(txProcessingContext_t *context) {
             context->tlvBufferPos = 0;
             context->processingField = true;
         }
-        switch (context->state) {
-            case TLV_CHAIN_ID:
-            case TLV_HEADER_EXPITATION:
-            case TLV_HEADER_REF_BLOCK_NUM:
-            case TLV_HEADER_REF_BLOCK_PREFIX:
-            case TLV_HEADER_MAX_CPU_USAGE_MS:
-            case TLV_HEADER_MAX_NET_USAGE_WORDS:
-            case TLV_HEADER_DELAY_SEC:
-                processField(context);
-                break;
-
-            case TLV_CFA_LIST_SIZE:
-                processZeroSizeField(context);
-                break;
-
-            case TLV_ACTION_LIST_SIZE:
-                processActionListSizeField(context);
-                break;
-
-            case TLV_ACTION_ACCOUNT:
-                processActionAccount(context);
-                break;
-
-            case TLV_ACTION_NAME:
-                processActionName(context);
-                break;
-
-            case TLV_AUTHORIZATION_LIST_SIZE:
-                processAuthorizationListSizeField(context);
-                break;
-
-            case TLV_AUTHORIZATION_ACTOR:
-                processField(context);
-                break;
-
-            case TLV_AUTHORIZATION_PERMISSION:
-                processAuthorizationPermission(context);
-                break;
-
-            case TLV_ACTION_DATA_SIZE:
-                if (isKnownAction(context) || context->dataAllowed == 0) {
-                    processField(context);
-                } else {
-                    processUnknownActionDataSize(context);
-                }
-                break;
-
-            case TLV_ACTION_DATA:
-                if (isKnownAction(context)) {
-                    processActionData(context);
-                } else if (context->dataAllowed == 1) {
-                    processUnknownActionData(context);
-                } else {
-                    PRINTF("UNKNOWN ACTION");
-                    return STREAM_FAULT;
-                }
-                break;
-
-            case TLV_TX_EXTENSION_LIST_SIZE:
-                processZeroSizeField(context);
-                break;
-
-            case TLV_CONTEXT_FREE_DATA:
-                processField(context);
-                break;
-
-            default:
-                PRINTF("Invalid TLV decoder context\n");
-                return STREAM_FAULT;
+        if (!processField(context)) {
+            return STREAM_FAULT;
         }
     }
 }
@@ -966,5 +1002,7 @@ parserStatus_e parseTx(txProcessingContext_t *context, uint8_t *buffer, uint32_t
         context->commandLength = length;
     }
 #endif
-    return processTxInternal(context);
+    parserStatus_e status = processTxInternal(context);
+    flushTxHash(context);
+    return status;
 }
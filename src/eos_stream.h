@@ -54,6 +54,40 @@ typedef enum txProcessingState_e {
     TLV_DONE
 } txProcessingState_e;
 
+struct actionDescriptor_t;
+
+#define REVIEW_QUEUE_SIZE 1024
+
+/**
+ * Actions of a transaction streamed before being reviewed. Each action is a header
+ * followed by its argument store, or by its checksum for an unknown action.
+ */
+typedef struct reviewQueue_t {
+    uint16_t length;
+    uint16_t readPos;
+    uint8_t buffer[REVIEW_QUEUE_SIZE];
+} reviewQueue_t;
+
+#define BATCH_MAX_RECIPIENTS 16
+#define BATCH_MAX_TOKENS     4
+
+/**
+ * Transfers of a batch of transactions, summed per recipient and per token so that the
+ * batch is reviewed once. All the transfers are made from one account on one token
+ * contract, without memo.
+ */
+typedef struct batchSummary_t {
+    name_t contract;
+    name_t from;
+    uint8_t transactionCount;
+    uint8_t recipientCount;
+    uint8_t tokenCount;
+    // Amount sent to each recipient, per token
+    name_t recipients[BATCH_MAX_RECIPIENTS];
+    asset_t amounts[BATCH_MAX_RECIPIENTS];
+    asset_t totals[BATCH_MAX_TOKENS];
+} batchSummary_t;
+
 typedef struct txProcessingContext_t {
     txProcessingState_e state;
     bool actionReady;
@@ -72,13 +106,32 @@ typedef struct txProcessingContext_t {
     uint32_t tlvBufferPos;
     uint8_t *workBuffer;
     uint32_t commandLength;
+    uint8_t *hashSpan;
+    uint32_t hashSpanLength;
+    uint32_t dataHashSpanLength;
     name_t contractName;
     name_t contractActionName;
-    uint8_t sizeBuffer[12];
-    uint8_t actionDataBuffer[512];
+    // Descriptor of the current action, NULL for an unknown action
+    const struct actionDescriptor_t *actionDescriptor;
+    // Argument store: values of the displayed fields of the current known action
+    uint8_t actionDataBuffer[492];
+    actionArgumentIndex_t argumentIndex;
+    actionDecoder_t actionDecoder;
     uint8_t dataAllowed;
+    bool packed;
+    // Value of the last varuint32 field: a list size, or the action data size of a packed
+    // transaction
+    varuint32_decoder_t varuint;
     checksum256 dataChecksum;
     txProcessingContent_t *content;
+    // Actions are queued for a review once the transaction is streamed, if not NULL
+    reviewQueue_t *reviewQueue;
+    // Transfers are summed for the review of a batch instead of being reviewed, if not NULL
+    batchSummary_t *batch;
+    bool batchReview;
+    // The transaction has no action for the batch, or its last action can't be summed into
+    // the batch or queued for review
+    bool actionRejected;
 } txProcessingContext_t;
 
 typedef enum parserStatus_e {
@@ -89,13 +142,41 @@ typedef enum parserStatus_e {
     STREAM_FINISHED,
 } parserStatus_e;
 
+#define REVIEW_CACHE_ARENA_SIZE    1024
+#define REVIEW_CACHE_MAX_ARGUMENTS 48
+
+/**
+ * Labels and values of the current action arguments, rendered once as NUL terminated
+ * strings so that the review pages can be browsed without formatting them again.
+ * argumentCount is 0 when the action does not fit, arguments are then rendered on demand.
+ */
+typedef struct reviewCache_t {
+    uint8_t argumentCount;
+    uint16_t labelOffset[REVIEW_CACHE_MAX_ARGUMENTS];
+    uint16_t dataOffset[REVIEW_CACHE_MAX_ARGUMENTS];
+    char arena[REVIEW_CACHE_ARENA_SIZE];
+} reviewCache_t;
+
 void initTxContext(txProcessingContext_t *context,
                    cx_sha256_t *sha256,
                    cx_sha256_t *dataSha256,
                    txProcessingContent_t *processingContent,
-                   uint8_t dataAllowed);
+                   uint8_t dataAllowed,
+                   bool packed,
+                   reviewQueue_t *reviewQueue);
 parserStatus_e parseTx(txProcessingContext_t *context, uint8_t *buffer, uint32_t length);
 
+void startQueuedReview(txProcessingContext_t *context);
+parserStatus_e reviewNextQueuedAction(txProcessingContext_t *context);
+
+bool startBatchReview(txProcessingContext_t *context);
+
 void printArgument(uint8_t argNum, txProcessingContext_t *processingContext);
 
+void fillReviewCache(txProcessingContext_t *processingContext, reviewCache_t *cache);
+bool getReviewCacheArgument(const reviewCache_t *cache,
+                            uint8_t argNum,
+                            const char **label,
+                            const char **data);
+
 #endif  // __EOS_STREAM_H__
@@ -108,72 +108,84 @@ uint8_t symbol_to_string(symbol_t sym, char *out, uint32_t size) {
 }
 
 uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size) {
-    UNUSED(size);
     LEDGER_ASSERT(asset != NULL, "asset_to_string Invalid Parameter");
+    // Sign, 19 digits, point, space and symbol
+    LEDGER_ASSERT(size >= 30, "asset_to_string Overflow");
 
-    int64_t p = (int64_t) symbol_precision(asset->symbol);
-    int64_t p10 = 1;
-    while (p > 0) {
-        p10 *= 10;
-        --p;
+    uint64_t precision = symbol_precision(asset->symbol);
+    LEDGER_ASSERT(precision <= 18, "asset_to_string Invalid precision");
+
+    uint32_t assetTextLength = 0;
+    uint64_t magnitude = (uint64_t) asset->amount;
+    if (asset->amount < 0) {
+        out[assetTextLength++] = '-';
+        magnitude = 0 - magnitude;
     }
+    assetTextLength += fixed_point_to_string(magnitude, precision, out + assetTextLength);
+    out[assetTextLength++] = ' ';
+    assetTextLength += symbol_to_string(asset->symbol, out + assetTextLength, 8);
 
-    p = (int64_t) symbol_precision(asset->symbol);
+    return assetTextLength;
+}
 
-    char fraction[p + 1];
-    fraction[p] = 0;
-    int64_t change = asset->amount % p10;
+void varuint32_decoder_init(varuint32_decoder_t *decoder) {
+    decoder->value = 0;
+    decoder->length = 0;
+    decoder->done = false;
+}
 
-    for (int64_t i = p - 1; i >= 0; --i) {
-        fraction[i] = (change % 10) + '0';
-        change /= 10;
+varuint32_status_e varuint32_decode_byte(varuint32_decoder_t *decoder, uint8_t byte) {
+    if (decoder->done) {
+        return VARUINT32_INVALID;
     }
-    char symbol[9];
-    memset(symbol, 0, sizeof(symbol));
-    symbol_to_string(asset->symbol, symbol, 8);
-
-    char tmp[64];
-    memset(tmp, 0, sizeof(tmp));
-    i64toa(asset->amount / p10, tmp);
-    uint32_t assetTextLength = strlen(tmp);
-    tmp[assetTextLength++] = '.';
-    memmove(tmp + assetTextLength, fraction, strlen(fraction));
-    assetTextLength = strlen(tmp);
-    tmp[assetTextLength++] = ' ';
-    memmove(tmp + assetTextLength, symbol, strlen(symbol));
-    assetTextLength = strlen(tmp);
-
-    memmove(out, tmp, assetTextLength);
-
-    return assetTextLength;
+    // The fifth byte holds the 4 upper bits, without continuation
+    if (decoder->length == 4 && byte > 0x0f) {
+        return VARUINT32_INVALID;
+    }
+    // A zero group after the first byte adds nothing, the encoding is not the shortest
+    if (decoder->length > 0 && byte == 0) {
+        return VARUINT32_INVALID;
+    }
+    decoder->value |= (uint32_t) (byte & 0x7f) << (7 * decoder->length++);
+    if (byte & 0x80) {
+        return VARUINT32_PENDING;
+    }
+    decoder->done = true;
+    return VARUINT32_DONE;
 }
 
 uint32_t unpack_variant32(uint8_t *in, uint32_t length, variant32_t *value) {
+    varuint32_decoder_t decoder;
+    varuint32_status_e status = VARUINT32_PENDING;
     uint32_t i = 0;
-    uint64_t v = 0;
-    char b = 0;
-    uint8_t by = 0;
-    do {
-        b = *in;
-        ++in;
-        ++i;
-        v |= (uint32_t) ((uint8_t) b & 0x7f) << by;
-        by += 7;
-    } while ((((uint8_t) b) & 0x80) && (by < 32) && (i < length));
-
-    *value = v;
+
+    varuint32_decoder_init(&decoder);
+    while (status == VARUINT32_PENDING) {
+        LEDGER_ASSERT(i < length, "unpack_variant32 Insufficient buffer");
+        status = varuint32_decode_byte(&decoder, in[i++]);
+    }
+    LEDGER_ASSERT(status == VARUINT32_DONE, "unpack_variant32 Invalid encoding");
+
+    *value = decoder.value;
     return i;
 }
 
+/**
+ * Compress an uncompressed public key (65 bytes) into out (33 bytes).
+ */
+void compress_public_key(const uint8_t *publicKey, uint8_t *out) {
+    // is even?
+    out[0] = (publicKey[64] & 0x1) ? 0x03 : 0x02;
+    memmove(out + 1, publicKey + 1, 32);
+}
+
 uint32_t public_key_to_wif(uint8_t *publicKey, uint32_t keyLength, char *out, uint32_t outLength) {
     LEDGER_ASSERT(publicKey != NULL, "public_key_to_wif Invalid Parameter");
     LEDGER_ASSERT(keyLength >= 33, "public_key_to_wif Invalid Parameter");
     LEDGER_ASSERT(outLength >= 40, "public_key_to_wif Overflow");
 
     uint8_t temp[33];
-    // is even?
-    temp[0] = (publicKey[64] & 0x1) ? 0x03 : 0x02;
-    memmove(temp + 1, publicKey + 1, 32);
+    compress_public_key(publicKey, temp);
     return compressed_public_key_to_wif(temp, sizeof(temp), out, outLength);
 }
 
@@ -18,6 +18,7 @@
 #ifndef __EOS_TYPES_H__
 #define __EOS_TYPES_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef uint32_t variant32_t;
@@ -52,6 +53,25 @@ typedef struct asset_t {
     symbol_t symbol;
 } asset_t;
 
+/**
+ * Incremental decoding of a varuint32 received byte by byte. Encodings longer than 5 bytes,
+ * with bits above 32 or with trailing zero groups are invalid.
+ */
+typedef struct varuint32_decoder_t {
+    uint32_t value;
+    uint8_t length;  // Bytes decoded
+    bool done;
+} varuint32_decoder_t;
+
+typedef enum varuint32_status_e {
+    VARUINT32_PENDING,
+    VARUINT32_DONE,
+    VARUINT32_INVALID,
+} varuint32_status_e;
+
+void varuint32_decoder_init(varuint32_decoder_t *decoder);
+varuint32_status_e varuint32_decode_byte(varuint32_decoder_t *decoder, uint8_t byte);
+
 uint32_t unpack_variant32(uint8_t *in, uint32_t length, variant32_t *value);
 
 name_t buffer_to_name_type(uint8_t *in, uint32_t size);
@@ -59,6 +79,7 @@ uint8_t name_to_string(name_t value, char *out, uint32_t size);
 
 uint8_t asset_to_string(asset_t *asset, char *out, uint32_t size);
 
+void compress_public_key(const uint8_t *publicKey, uint8_t *out);
 uint32_t public_key_to_wif(uint8_t *publicKey, uint32_t keyLength, char *out, uint32_t outLength);
 uint32_t compressed_public_key_to_wif(uint8_t *publicKey,
                                       uint32_t keyLength,
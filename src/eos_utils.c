@@ -26,41 +26,69 @@ unsigned char const BASE58ALPHABET[] = {'1', '2', '3', '4', '5', '6', '7', '8',
                                         'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'm', 'n', 'o', 'p',
                                         'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'};
 
+// Largest input of b58enc, a public key and its checksum take 37 bytes
+#define B58ENC_MAX_INPUT_SIZE 64
+// The number is converted in limbs of 5 base58 digits, 58^5 < 2^30
+#define B58_LIMB_DIGITS 5
+#define B58_LIMB_BASE   656356768u
+#define B58_MAX_LIMBS   (B58ENC_MAX_INPUT_SIZE * 138 / 100 / B58_LIMB_DIGITS + 2)
+
 bool b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz) {
-    int carry;
-    uint32_t i, j, high, zcount = 0;
-    uint32_t size;
+    uint32_t limbs[B58_MAX_LIMBS];
+    uint32_t limbCount = 0;
+    uint32_t i, j, zcount = 0;
+    uint32_t digits, value;
+
+    LEDGER_ASSERT(binsz <= B58ENC_MAX_INPUT_SIZE, "b58enc Input too long");
 
     while (zcount < binsz && !bin[zcount]) ++zcount;
 
-    size = (binsz - zcount) * 138 / 100 + 1;
-    uint8_t buf[size];
-    memset(buf, 0, size);
-
-    for (i = zcount, high = size - 1; i < binsz; ++i, high = j) {
-        for (carry = bin[i], j = size - 1; (j > high) || carry; --j) {
-            carry += 256 * buf[j];
-            buf[j] = carry % 58;
-            carry /= 58;
-            if (!j) {
-                // Otherwise j wraps to maxint which is > high
-                break;
-            }
+    // Multiply the limbs, least significant first, by 2^32 and add the next 4 input
+    // bytes. The first word takes the bytes left over so that the others are whole.
+    i = zcount;
+    while (i < binsz) {
+        uint32_t wordSize = (binsz - i) % 4 ? (binsz - i) % 4 : 4;
+        uint64_t carry = 0;
+
+        for (j = 0; j < wordSize; j++) {
+            carry = (carry << 8) | bin[i++];
+        }
+        for (j = 0; j < limbCount; j++) {
+            carry += (uint64_t) limbs[j] << (8 * wordSize);
+            limbs[j] = carry % B58_LIMB_BASE;
+            carry /= B58_LIMB_BASE;
+        }
+        while (carry) {
+            limbs[limbCount++] = carry % B58_LIMB_BASE;
+            carry /= B58_LIMB_BASE;
         }
     }
 
-    for (j = 0; j < size && !buf[j]; ++j)
-        ;
+    // Significant digits: whole limbs and the digits of the most significant one
+    digits = 0;
+    if (limbCount) {
+        digits = (limbCount - 1) * B58_LIMB_DIGITS;
+        for (value = limbs[limbCount - 1]; value; value /= 58) {
+            digits++;
+        }
+    }
 
-    if (*b58sz <= zcount + size - j) {
-        *b58sz = zcount + size - j + 1;
+    if (*b58sz <= zcount + digits) {
+        *b58sz = zcount + digits + 1;
         return false;
     }
 
     if (zcount) memset(b58, '1', zcount);
-    for (i = zcount; j < size; ++i, ++j) b58[i] = BASE58ALPHABET[buf[j]];
+    i = zcount + digits;
     b58[i] = '\0';
-    *b58sz = i + 1;
+    for (j = 0; j < limbCount; j++) {
+        value = limbs[j];
+        for (uint32_t k = 0; k < B58_LIMB_DIGITS && i > zcount; k++) {
+            b58[--i] = BASE58ALPHABET[value % 58];
+            value /= 58;
+        }
+    }
+    *b58sz = zcount + digits + 1;
 
     return true;
 }
@@ -77,38 +105,80 @@ void array_hexstr(char *strbuf, const void *bin, unsigned int len) {
     *strbuf = 0;  // EOS
 }
 
-char const digit[] = "0123456789";
+static const uint64_t POWERS_OF_TEN[20] = {1ull,
+                                           10ull,
+                                           100ull,
+                                           1000ull,
+                                           10000ull,
+                                           100000ull,
+                                           1000000ull,
+                                           10000000ull,
+                                           100000000ull,
+                                           1000000000ull,
+                                           10000000000ull,
+                                           100000000000ull,
+                                           1000000000000ull,
+                                           10000000000000ull,
+                                           100000000000000ull,
+                                           1000000000000000ull,
+                                           10000000000000000ull,
+                                           100000000000000000ull,
+                                           1000000000000000000ull,
+                                           10000000000000000000ull};
+
+/**
+ * Take the digit of rank k (the one of 10^k) out of value, by subtracting 8, 4, 2 and 1
+ * times 10^k. The digits of the higher ranks must already be taken out.
+ */
+static char take_digit(uint64_t *value, uint8_t k) {
+    uint64_t power = POWERS_OF_TEN[k];
+    uint8_t digit = 0;
+    uint8_t shift = 3;
+
+    // Below 2^64 the digit of 10^19 is at most 1, and 2 * 10^19 overflows
+    if (k == 19) {
+        shift = 0;
+    }
+    do {
+        // Subtract without branching, the comparisons are not predictable
+        uint64_t mask = 0 - (uint64_t) (*value >= power << shift);
+        *value -= (power << shift) & mask;
+        digit |= (1 << shift) & mask;
+    } while (shift--);
+    return '0' + digit;
+}
+
+uint32_t fixed_point_to_string(uint64_t value, uint8_t decimals, char *out) {
+    uint8_t digits = decimals + 1;
+    uint32_t length = 0;
+
+    LEDGER_ASSERT(decimals < 20, "fixed_point_to_string Invalid decimals");
+
+    while (digits < 20 && value >= POWERS_OF_TEN[digits]) {
+        digits++;
+    }
+    while (digits--) {
+        if (decimals != 0 && digits == decimals - 1) {
+            out[length++] = '.';
+        }
+        out[length++] = take_digit(&value, digits);
+    }
+    return length;
+}
+
 char *i64toa(int64_t i, char b[]) {
     char *p = b;
+    uint64_t magnitude = (uint64_t) i;
     if (i < 0) {
         *p++ = '-';
-        i *= -1;
+        magnitude = 0 - magnitude;
     }
-    int64_t shifter = i;
-    do {  // Move to where representation ends
-        ++p;
-        shifter = shifter / 10;
-    } while (shifter);
-    *p = '\0';
-    do {  // Move back, inserting digits as u go
-        *--p = digit[i % 10];
-        i = i / 10;
-    } while (i);
+    p[fixed_point_to_string(magnitude, 0, p)] = '\0';
     return b;
 }
 
 char *ui64toa(uint64_t i, char b[]) {
-    char *p = b;
-    uint64_t shifter = i;
-    do {  // Move to where representation ends
-        ++p;
-        shifter = shifter / 10;
-    } while (shifter);
-    *p = '\0';
-    do {  // Move back, inserting digits as u go
-        *--p = digit[i % 10];
-        i = i / 10;
-    } while (i);
+    b[fixed_point_to_string(i, 0, b)] = '\0';
     return b;
 }
 
@@ -131,9 +201,14 @@ static void decodeTag(uint8_t byte, uint8_t *cls, uint8_t *type, uint8_t *nr) {
 
 /**
  * tlv buffer is 5 bytes long. First byte is used for tag.
- * Next, up to four bytes could be used to to encode length.
+ * Next, the length takes a byte, and up to three more for a long form.
+ * On success headerLength receives the number of bytes used by tag and length.
  */
-bool tlvTryDecode(uint8_t *buffer, uint32_t bufferLength, uint32_t *fieldLenght, bool *valid) {
+bool tlvTryDecode(uint8_t *buffer,
+                  uint32_t bufferLength,
+                  uint32_t *fieldLenght,
+                  uint32_t *headerLength,
+                  bool *valid) {
     uint8_t class, type, number;
     decodeTag(*buffer, &class, &type, &number);
 
@@ -154,8 +229,9 @@ bool tlvTryDecode(uint8_t *buffer, uint32_t bufferLength, uint32_t *fieldLenght,
     if (byte & 0x80) {
         uint8_t i;
         uint8_t count = byte & 0x7f;
-        if (count > 4) {
-            // Its allowed to have up to 4 bytes for length
+        if (count > 3) {
+            // Its allowed to have up to 4 bytes for length, as a header split across
+            // chunks is buffered in the 5 bytes of the tlv buffer
             // [.] Tag
             //    [. . . .] Length
             *valid = false;
@@ -173,8 +249,10 @@ bool tlvTryDecode(uint8_t *buffer, uint32_t bufferLength, uint32_t *fieldLenght,
         for (i = 0; i < count; ++i) {
             length = (length << 8) | *(buffer + i);
         }
+        *headerLength = 2 + count;
     } else {
         length = byte;
+        *headerLength = 2;
     }
     *fieldLenght = length;
     *valid = true;
@@ -190,61 +268,77 @@ unsigned char check_canonical(uint8_t *rs) {
            !(rs[32] == 0 && !(rs[33] & 0x80));
 }
 
-int ecdsa_der_to_sig(const uint8_t *der, uint8_t *sig) {
-    int length;
-    int offset = 2;
-    int delta = 0;
-    if (der[offset + 2] == 0) {
-        length = der[offset + 1] - 1;
-        offset += 3;
-    } else {
-        length = der[offset + 1];
-        offset += 2;
-    }
-    if ((length < 0) || (length > 32)) {
-        return 0;
+/**
+ * HMAC_K key schedule: SHA-256 states with K ^ ipad and K ^ opad already absorbed.
+ * An HMAC with an unchanged K then costs the compressions of its message and of the
+ * outer digest only.
+ */
+static void rfc6979_set_key(rfc6979_state_t *state, const uint8_t *key) {
+    uint8_t pad[64];
+    uint32_t i;
+
+    memset(pad, 0, sizeof(pad));
+    memmove(pad, key, 32);
+    for (i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36;
     }
-    while ((length + delta) < 32) {
-        sig[delta++] = 0;
+    CX_ASSERT(cx_sha256_init_no_throw(&state->inner));
+    CX_ASSERT(cx_hash_no_throw(&state->inner.header, 0, pad, sizeof(pad), NULL, 0));
+    for (i = 0; i < sizeof(pad); i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
     }
-    memmove(sig + delta, der + offset, length);
+    CX_ASSERT(cx_sha256_init_no_throw(&state->outer));
+    CX_ASSERT(cx_hash_no_throw(&state->outer.header, 0, pad, sizeof(pad), NULL, 0));
+    explicit_bzero(pad, sizeof(pad));
+}
 
-    delta = 0;
-    offset += length;
-    if (der[offset + 2] == 0) {
-        length = der[offset + 1] - 1;
-        offset += 3;
-    } else {
-        length = der[offset + 1];
-        offset += 2;
-    }
-    if ((length < 0) || (length > 32)) {
-        return 0;
+/**
+ * out = HMAC_K(V || separator || x || h1), the separator is skipped if negative.
+ * out may alias V.
+ */
+static void rfc6979_hmac(const rfc6979_state_t *state,
+                         int separator,
+                         const uint8_t *x,
+                         uint32_t x_len,
+                         const uint8_t *h1,
+                         uint8_t *out) {
+    cx_sha256_t sha;
+    uint8_t digest[32];
+
+    memmove(&sha, &state->inner, sizeof(sha));
+    CX_ASSERT(cx_hash_no_throw(&sha.header, 0, state->V, 32, NULL, 0));
+    if (separator >= 0) {
+        uint8_t byte = separator;
+        CX_ASSERT(cx_hash_no_throw(&sha.header, 0, &byte, 1, NULL, 0));
     }
-    while ((length + delta) < 32) {
-        sig[32 + delta++] = 0;
+    if (x != NULL) {
+        CX_ASSERT(cx_hash_no_throw(&sha.header, 0, x, x_len, NULL, 0));
+        CX_ASSERT(cx_hash_no_throw(&sha.header, 0, h1, 32, NULL, 0));
     }
-    memmove(sig + 32 + delta, der + offset, length);
-
-    return 1;
+    CX_ASSERT(cx_hash_no_throw(&sha.header, CX_LAST, NULL, 0, digest, sizeof(digest)));
+    memmove(&sha, &state->outer, sizeof(sha));
+    CX_ASSERT(cx_hash_no_throw(&sha.header, CX_LAST, digest, sizeof(digest), out, 32));
+    explicit_bzero(&sha, sizeof(sha));
 }
 
 /**
  * The nonce generated by internal library CX_RND_RFC6979 is not compatible
  * with EOS. So this is the way to generate nonve for EOS.
+ * The first call takes the private key x and starts the generator, the next ones
+ * pass x as NULL to get the following candidates, with the same state.
  */
 void rng_rfc6979(unsigned char *rnd,
-                 unsigned char *h1,
-                 unsigned char *x,
+                 const unsigned char *h1,
+                 const unsigned char *x,
                  unsigned int x_len,
                  const unsigned char *q,
                  unsigned int q_len,
-                 unsigned char *V,
-                 unsigned char *K) {
-    unsigned int h_len, offset, found, i;
-    cx_hmac_sha256_t hmac;
+                 rfc6979_state_t *state) {
+    uint8_t K[32];
+    unsigned int found, i;
+
+    LEDGER_ASSERT(q_len == 32, "Unsupported order length");
 
-    h_len = 32;
     // a. h1 as input
 
     // loop for a candidate
@@ -252,38 +346,30 @@ void rng_rfc6979(unsigned char *rnd,
     while (!found) {
         if (x) {
             // b.  Set:          V = 0x01 0x01 0x01 ... 0x01
-            memset(V, 0x01, h_len);
+            memset(state->V, 0x01, sizeof(state->V));
             // c. Set: K = 0x00 0x00 0x00 ... 0x00
-            memset(K, 0x00, h_len);
+            memset(K, 0x00, sizeof(K));
+            rfc6979_set_key(state, K);
             // d.  Set: K = HMAC_K(V || 0x00 || int2octets(x) || bits2octets(h1))
-            V[h_len] = 0;
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, 0, V, h_len + 1, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, 0, x, x_len, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, h1, h_len, K, 32));
+            rfc6979_hmac(state, 0x00, x, x_len, h1, K);
+            rfc6979_set_key(state, K);
             // e.  Set: V = HMAC_K(V)
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, V, h_len, V, 32));
+            rfc6979_hmac(state, -1, NULL, 0, NULL, state->V);
             // f.  Set:  K = HMAC_K(V || 0x01 || int2octets(x) || bits2octets(h1))
-            V[h_len] = 1;
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, 0, V, h_len + 1, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, 0, x, x_len, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, h1, h_len, K, 32));
+            rfc6979_hmac(state, 0x01, x, x_len, h1, K);
+            rfc6979_set_key(state, K);
             // g. Set: V = HMAC_K(V) --
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, V, h_len, V, 32));
+            rfc6979_hmac(state, -1, NULL, 0, NULL, state->V);
             // initial setup only once
             x = NULL;
         } else {
             // h.3  K = HMAC_K(V || 0x00)
-            V[h_len] = 0;
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, V, h_len + 1, K, 32));
+            rfc6979_hmac(state, 0x00, NULL, 0, NULL, K);
+            rfc6979_set_key(state, K);
             // h.3 V = HMAC_K(V)
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, V, h_len, V, 32));
+            rfc6979_hmac(state, -1, NULL, 0, NULL, state->V);
         }
+        explicit_bzero(K, sizeof(K));
 
         // generate candidate
         /* Shortcut: As only secp256k1/sha256 is supported, the step h.2 :
@@ -293,21 +379,12 @@ void rng_rfc6979(unsigned char *rnd,
          * is replace by
          *     V = HMAC_K(V)
          */
-        x_len = q_len;
-        offset = 0;
-        while (x_len) {
-            if (x_len < h_len) {
-                h_len = x_len;
-            }
-            CX_ASSERT(cx_hmac_sha256_init_no_throw(&hmac, K, 32));
-            CX_ASSERT(cx_hmac_no_throw((cx_hmac_t *) &hmac, CX_LAST, V, h_len, V, 32));
-            memmove(rnd + offset, V, h_len);
-            x_len -= h_len;
-        }
+        rfc6979_hmac(state, -1, NULL, 0, NULL, state->V);
+        memmove(rnd, state->V, q_len);
 
         // h.3 Check T is < n
         for (i = 0; i < q_len; i++) {
-            if (V[i] < q[i]) {
+            if (state->V[i] < q[i]) {
                 found = 1;
                 break;
             }
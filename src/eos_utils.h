@@ -20,27 +20,45 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "cx.h"
 
 bool b58enc(uint8_t *data, uint32_t binsz, char *b58, uint32_t *b58sz);
 
 void array_hexstr(char *strbuf, const void *bin, unsigned int len);
 
+/**
+ * Write the decimal digits of value, with a '.' before the last decimals ones, at least
+ * one digit before it. The string is not terminated, its length is returned.
+ */
+uint32_t fixed_point_to_string(uint64_t value, uint8_t decimals, char *out);
+
 char *i64toa(int64_t i, char b[]);
 char *ui64toa(uint64_t i, char b[]);
 
-bool tlvTryDecode(uint8_t *buffer, uint32_t bufferLength, uint32_t *fieldLenght, bool *valid);
+bool tlvTryDecode(uint8_t *buffer,
+                  uint32_t bufferLength,
+                  uint32_t *fieldLenght,
+                  uint32_t *headerLength,
+                  bool *valid);
 
 unsigned char check_canonical(uint8_t *rs);
 
-int ecdsa_der_to_sig(const uint8_t *der, uint8_t *sig);
+/**
+ * State of the RFC 6979 nonce generator: V and the key schedule of the current K.
+ * It holds secret material and must be wiped once the signature is computed.
+ */
+typedef struct rfc6979_state_t {
+    uint8_t V[32];
+    cx_sha256_t inner;
+    cx_sha256_t outer;
+} rfc6979_state_t;
 
 void rng_rfc6979(unsigned char *rnd,
-                 unsigned char *h1,
-                 unsigned char *x,
+                 const unsigned char *h1,
+                 const unsigned char *x,
                  unsigned int x_len,
                  const unsigned char *q,
                  unsigned int q_len,
-                 unsigned char *V,
-                 unsigned char *K);
+                 rfc6979_state_t *state);
 
 #endif
@@ -34,17 +34,34 @@
 
 uint32_t get_public_key_and_set_result(void);
 uint32_t sign_hash_and_set_result(void);
+uint32_t sign_digest_and_set_result(void);
 
 #define CLA                       0xD4
 #define INS_GET_PUBLIC_KEY        0x02
 #define INS_SIGN                  0x04
 #define INS_GET_APP_CONFIGURATION 0x06
+#define INS_GET_PUBLIC_KEYS       0x08
+#define INS_GET_LAST_SIGNATURE    0x0A
 #define P1_CONFIRM                0x01
 #define P1_NON_CONFIRM            0x00
 #define P2_NO_CHAINCODE           0x00
 #define P2_CHAINCODE              0x01
+#define P2_EXTENDED_PUBLIC_KEY    0x02
+#define P2_NO_ADDRESS             0x00
+#define P2_ADDRESS                0x01
 #define P1_FIRST                  0x00
 #define P1_MORE                   0x80
+#define P2_TLV_TRANSACTION        0x00
+#define P2_PACKED_TRANSACTION     0x01
+#define P2_SEQUENCED_CHUNKS       0x02
+#define P2_REVIEW_AFTER_STREAM    0x04
+#define P2_CACHE_SIGNING_KEY      0x08
+#define P2_MULTIPLE_PATHS         0x10
+#define P2_BATCH                  0x20
+
+// Sequenced SIGN chunks start with a sequence number (2 bytes) and the offset of the
+// chunk in the transaction (4 bytes), big endian
+#define SIGN_CHUNK_HEADER_LENGTH 6
 
 uint8_t const SECP256K1_N[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
                                0xff, 0xff, 0xff, 0xff, 0xfe, 0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48,
@@ -57,6 +74,94 @@ txProcessingContext_t txProcessingCtx;
 txProcessingContent_t txContent;
 sharedContext_t tmpCtx;
 
+/**
+ * Last chunk of a transaction sent with P2_SEQUENCED_CHUNKS. A chunk sent again after
+ * its response was lost is answered again without being parsed a second time.
+ */
+typedef struct signSequence_t {
+    bool enabled;
+    uint16_t sequence;
+    uint32_t offset;
+    uint16_t length;
+    uint32_t crc;
+    // Status word answered to the last chunk, 0 until the answer is known
+    uint16_t status;
+} signSequence_t;
+
+static signSequence_t signSequence;
+
+/**
+ * Signing key of the transaction path. It is derived as soon as the path is received,
+ * so that the derivation runs while the transaction is streamed and reviewed rather
+ * than once the last action is approved. It is wiped on reject or error, and after
+ * signing unless the host opts in with P2_CACHE_SIGNING_KEY: it is then kept for the
+ * next transactions on the same path, until another path is used or the app is left.
+ */
+typedef struct signingKey_t {
+    bool valid;
+    uint8_t pathLength;
+    uint32_t bip32Path[MAX_BIP32_PATH];
+    cx_ecfp_private_key_t privateKey;
+} signingKey_t;
+
+static signingKey_t signingKey;
+
+#define SIGNATURE_LENGTH (1 + 64)
+
+/**
+ * Last signature returned, so that it can be fetched again without a new review when
+ * its response is lost. It is cleared when another transaction is started, when a
+ * transaction is rejected, and when the app is left.
+ */
+typedef struct lastSignature_t {
+    bool valid;
+    uint8_t hash[32];
+    uint8_t length;
+    uint8_t signatures[MAX_SIGNING_PATHS * SIGNATURE_LENGTH];
+} lastSignature_t;
+
+static lastSignature_t lastSignature;
+
+#ifdef HAVE_BATCH_SIGNING
+#define BATCH_MAX_TRANSACTIONS 16
+
+/**
+ * Transactions streamed one after the other and reviewed at once. Once approved, their
+ * signatures are fetched by digest. The batch ends when another transaction is started,
+ * when a command fails, when the batch is rejected, and when the app is left.
+ */
+typedef struct batchSession_t {
+    uint8_t transactionCount;
+    uint8_t streamedCount;
+    bool approved;
+    bool cacheSigningKey;
+    uint32_t signedMask;
+    uint8_t pathLength;
+    uint32_t bip32Path[MAX_BIP32_PATH];
+    uint8_t hashes[BATCH_MAX_TRANSACTIONS][32];
+    batchSummary_t summary;
+} batchSession_t;
+
+static batchSession_t batchSession;
+#endif
+
+void wipe_signing_key(void) {
+    explicit_bzero(&signingKey, sizeof(signingKey));
+}
+
+void clear_last_signature(void) {
+    memset(&lastSignature, 0, sizeof(lastSignature));
+#ifdef HAVE_BATCH_SIGNING
+    memset(&batchSession, 0, sizeof(batchSession));
+#endif
+}
+
+void quit_app(void) {
+    wipe_signing_key();
+    clear_last_signature();
+    os_sched_exit(-1);
+}
+
 static void io_exchange_with_code(uint16_t code, uint32_t tx) {
     G_io_apdu_buffer[tx++] = code >> 8;
     G_io_apdu_buffer[tx++] = code & 0xFF;
@@ -80,6 +185,9 @@ unsigned int user_action_address_cancel(void) {
 }
 
 unsigned int user_action_tx_cancel(void) {
+    wipe_signing_key();
+    clear_last_signature();
+    signSequence.status = 0x6985;
     io_exchange_with_code(0x6985, 0);
 
     ui_display_action_sign_done(STREAM_FINISHED, false);
@@ -87,20 +195,39 @@ unsigned int user_action_tx_cancel(void) {
 }
 
 void user_action_sign_flow_ok(void) {
-    parserStatus_e txResult = parseTx(&txProcessingCtx, NULL, 0);
+    parserStatus_e txResult;
+#ifdef HAVE_BATCH_SIGNING
+    if (txProcessingCtx.batchReview) {
+        // The signatures are fetched one by one
+        batchSession.approved = true;
+        signSequence.status = 0x9000;
+        io_exchange_with_code(0x9000, 0);
+        ui_display_action_sign_done(STREAM_FINISHED, true);
+        return;
+    }
+#endif
+    if (txProcessingCtx.reviewQueue != NULL) {
+        txResult = reviewNextQueuedAction(&txProcessingCtx);
+    } else {
+        txResult = parseTx(&txProcessingCtx, NULL, 0);
+    }
     switch (txResult) {
         case STREAM_ACTION_READY:
             ui_display_single_action_sign_flow();
             break;
         case STREAM_PROCESSING:
+            signSequence.status = 0x9000;
             io_exchange_with_code(0x9000, 0);
             ui_display_action_sign_done(STREAM_PROCESSING, true);
             break;
         case STREAM_FINISHED:
+            signSequence.status = 0x9000;
             io_exchange_with_code(0x9000, sign_hash_and_set_result());
             ui_display_action_sign_done(STREAM_FINISHED, true);
             break;
         default:
+            wipe_signing_key();
+            signSequence.status = 0x6A80;
             io_exchange_with_code(0x6A80, 0);
             // Display back the original UX
             ui_idle();
@@ -110,6 +237,11 @@ void user_action_sign_flow_ok(void) {
 
 uint32_t get_public_key_and_set_result() {
     uint32_t tx = 0;
+    if (tmpCtx.publicKeyContext.extended) {
+        compress_public_key(tmpCtx.publicKeyContext.publicKey.W, G_io_apdu_buffer);
+        memmove(G_io_apdu_buffer + 33, tmpCtx.publicKeyContext.chainCode, 32);
+        return 33 + 32;
+    }
     G_io_apdu_buffer[tx++] = 65;
     memmove(G_io_apdu_buffer + tx, tmpCtx.publicKeyContext.publicKey.W, 65);
     tx += 65;
@@ -126,6 +258,24 @@ uint32_t get_public_key_and_set_result() {
     return tx;
 }
 
+static void derive_public_key(const uint32_t *bip32Path,
+                              uint8_t bip32PathLength,
+                              cx_ecfp_public_key_t *publicKey,
+                              uint8_t *chainCode) {
+    uint8_t privateKeyData[64];
+    cx_ecfp_private_key_t privateKey;
+
+    CX_ASSERT(os_derive_bip32_no_throw(CX_CURVE_256K1,
+                                       bip32Path,
+                                       bip32PathLength,
+                                       privateKeyData,
+                                       chainCode));
+    CX_ASSERT(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1, privateKeyData, 32, &privateKey));
+    CX_ASSERT(cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1, publicKey, &privateKey, 1));
+    memset(&privateKey, 0, sizeof(privateKey));
+    memset(privateKeyData, 0, sizeof(privateKeyData));
+}
+
 uint32_t handleGetPublicKey(uint8_t p1,
                             uint8_t p2,
                             uint8_t *dataBuffer,
@@ -133,12 +283,12 @@ uint32_t handleGetPublicKey(uint8_t p1,
                             volatile unsigned int *flags,
                             volatile unsigned int *tx) {
     UNUSED(dataLength);
-    uint8_t privateKeyData[64];
     uint32_t bip32Path[MAX_BIP32_PATH];
     uint32_t i;
     uint8_t bip32PathLength = *(dataBuffer++);
-    cx_ecfp_private_key_t privateKey;
 
+    // The public key context overwrites the digest of the last transaction
+    signSequence.enabled = false;
     if ((bip32PathLength < 0x01) || (bip32PathLength > MAX_BIP32_PATH)) {
         PRINTF("Invalid path\n");
         return 0x6a80;
@@ -146,7 +296,7 @@ uint32_t handleGetPublicKey(uint8_t p1,
     if ((p1 != P1_CONFIRM) && (p1 != P1_NON_CONFIRM)) {
         return 0x6B00;
     }
-    if ((p2 != P2_CHAINCODE) && (p2 != P2_NO_CHAINCODE)) {
+    if ((p2 != P2_CHAINCODE) && (p2 != P2_NO_CHAINCODE) && (p2 != P2_EXTENDED_PUBLIC_KEY)) {
         return 0x6B00;
     }
     for (i = 0; i < bip32PathLength; i++) {
@@ -154,20 +304,17 @@ uint32_t handleGetPublicKey(uint8_t p1,
             (dataBuffer[0] << 24) | (dataBuffer[1] << 16) | (dataBuffer[2] << 8) | (dataBuffer[3]);
         dataBuffer += 4;
     }
-    tmpCtx.publicKeyContext.getChaincode = (p2 == P2_CHAINCODE);
-    CX_ASSERT(os_derive_bip32_no_throw(
-        CX_CURVE_256K1,
+    // Extended public keys are only exported for hardened nodes, such as an account
+    if ((p2 == P2_EXTENDED_PUBLIC_KEY) && ((bip32Path[bip32PathLength - 1] & 0x80000000) == 0)) {
+        return 0x6a80;
+    }
+    tmpCtx.publicKeyContext.getChaincode = (p2 != P2_NO_CHAINCODE);
+    tmpCtx.publicKeyContext.extended = (p2 == P2_EXTENDED_PUBLIC_KEY);
+    derive_public_key(
         bip32Path,
         bip32PathLength,
-        privateKeyData,
-        (tmpCtx.publicKeyContext.getChaincode ? tmpCtx.publicKeyContext.chainCode : NULL)));
-    CX_ASSERT(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1, privateKeyData, 32, &privateKey));
-    CX_ASSERT(cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1,
-                                             &tmpCtx.publicKeyContext.publicKey,
-                                             &privateKey,
-                                             1));
-    memset(&privateKey, 0, sizeof(privateKey));
-    memset(privateKeyData, 0, sizeof(privateKeyData));
+        &tmpCtx.publicKeyContext.publicKey,
+        (tmpCtx.publicKeyContext.getChaincode ? tmpCtx.publicKeyContext.chainCode : NULL));
     public_key_to_wif(tmpCtx.publicKeyContext.publicKey.W,
                       sizeof(tmpCtx.publicKeyContext.publicKey.W),
                       tmpCtx.publicKeyContext.address,
@@ -182,6 +329,75 @@ uint32_t handleGetPublicKey(uint8_t p1,
     return SWO_SUCCESS;
 }
 
+// Longest EOS WIF public key: "EOS" followed by 37 bytes in base 58
+#define WIF_PUBLIC_KEY_MAX_LENGTH (3 + 51)
+// Largest response data, the status word excluded
+#define MAX_RESPONSE_LENGTH 255
+
+/**
+ * Return the compressed public keys of consecutive children of a base path, as many
+ * as fit in the response. The WIF addresses are only encoded if requested.
+ */
+uint32_t handleGetPublicKeys(uint8_t p1,
+                             uint8_t p2,
+                             uint8_t *dataBuffer,
+                             uint16_t dataLength,
+                             volatile unsigned int *flags,
+                             volatile unsigned int *tx) {
+    UNUSED(flags);
+    uint32_t bip32Path[MAX_BIP32_PATH];
+    uint32_t i;
+    uint8_t bip32PathLength = dataBuffer[0];
+    cx_ecfp_public_key_t publicKey;
+
+    if (p1 != P1_NON_CONFIRM) {
+        return 0x6B00;
+    }
+    if ((p2 != P2_ADDRESS) && (p2 != P2_NO_ADDRESS)) {
+        return 0x6B00;
+    }
+    // Base path, start index (4 bytes) and count (1 byte)
+    if ((dataLength < 1) || (bip32PathLength >= MAX_BIP32_PATH) ||
+        (dataLength != 1 + 4 * bip32PathLength + 5)) {
+        PRINTF("Invalid path\n");
+        return 0x6a80;
+    }
+    dataBuffer++;
+    for (i = 0; i <= bip32PathLength; i++) {
+        bip32Path[i] =
+            (dataBuffer[0] << 24) | (dataBuffer[1] << 16) | (dataBuffer[2] << 8) | (dataBuffer[3]);
+        dataBuffer += 4;
+    }
+    uint32_t startIndex = bip32Path[bip32PathLength];
+    uint8_t count = dataBuffer[0];
+    // Children must be either all hardened or all normal
+    if ((count == 0) || ((startIndex ^ (startIndex + count - 1)) & 0x80000000) != 0) {
+        return 0x6a80;
+    }
+
+    uint32_t entryLength = 33 + (p2 == P2_ADDRESS ? 1 + WIF_PUBLIC_KEY_MAX_LENGTH : 0);
+    uint32_t length = 1;
+    uint8_t returned = 0;
+    while (returned < count && length + entryLength <= MAX_RESPONSE_LENGTH) {
+        bip32Path[bip32PathLength] = startIndex + returned;
+        derive_public_key(bip32Path, bip32PathLength + 1, &publicKey, NULL);
+        compress_public_key(publicKey.W, G_io_apdu_buffer + length);
+        if (p2 == P2_ADDRESS) {
+            char address[WIF_PUBLIC_KEY_MAX_LENGTH + 1];
+            uint32_t addressLength =
+                public_key_to_wif(publicKey.W, sizeof(publicKey.W), address, sizeof(address));
+            G_io_apdu_buffer[length + 33] = addressLength;
+            memmove(G_io_apdu_buffer + length + 34, address, addressLength);
+            length += 1 + addressLength;
+        }
+        length += 33;
+        returned++;
+    }
+    G_io_apdu_buffer[0] = returned;
+    *tx = length;
+    return SWO_SUCCESS;
+}
+
 uint32_t handleGetAppConfiguration(uint8_t p1,
                                    uint8_t p2,
                                    uint8_t *workBuffer,
@@ -201,6 +417,71 @@ uint32_t handleGetAppConfiguration(uint8_t p1,
     return SWO_SUCCESS;
 }
 
+#ifdef HAVE_BATCH_SIGNING
+/**
+ * Sign a transaction of an approved batch, given its digest. Return 0 if the digest
+ * is not the one of a transaction of the batch.
+ */
+static uint32_t sign_batch_transaction(const uint8_t *hash) {
+    uint8_t i;
+
+    if (!batchSession.approved) {
+        return 0;
+    }
+    for (i = 0; i < batchSession.streamedCount; i++) {
+        if (memcmp(hash, batchSession.hashes[i], 32) == 0) {
+            break;
+        }
+    }
+    if (i == batchSession.streamedCount) {
+        return 0;
+    }
+    memmove(tmpCtx.transactionContext.hash, hash, sizeof(tmpCtx.transactionContext.hash));
+    tmpCtx.transactionContext.pathLength = batchSession.pathLength;
+    memmove(tmpCtx.transactionContext.bip32Path,
+            batchSession.bip32Path,
+            sizeof(tmpCtx.transactionContext.bip32Path));
+    tmpCtx.transactionContext.additionalPathCount = 0;
+    // The key is kept until all the signatures of the batch are fetched
+    batchSession.signedMask |= 1 << i;
+    tmpCtx.transactionContext.cacheSigningKey =
+        batchSession.cacheSigningKey ||
+        batchSession.signedMask != (1u << batchSession.transactionCount) - 1;
+    return sign_digest_and_set_result();
+}
+#endif
+
+uint32_t handleGetLastSignature(uint8_t p1,
+                                uint8_t p2,
+                                uint8_t *workBuffer,
+                                uint16_t dataLength,
+                                volatile unsigned int *flags,
+                                volatile unsigned int *tx) {
+    UNUSED(flags);
+    if ((p1 != 0) || (p2 != 0)) {
+        return 0x6B00;
+    }
+    if (dataLength != sizeof(lastSignature.hash)) {
+        return 0x6A80;
+    }
+    if (lastSignature.valid &&
+        memcmp(workBuffer, lastSignature.hash, sizeof(lastSignature.hash)) == 0) {
+        memmove(G_io_apdu_buffer, lastSignature.signatures, lastSignature.length);
+        *tx = lastSignature.length;
+        return SWO_SUCCESS;
+    }
+#ifdef HAVE_BATCH_SIGNING
+    *tx = sign_batch_transaction(workBuffer);
+    if (*tx != 0) {
+        return SWO_SUCCESS;
+    }
+    if (batchSession.approved) {
+        return 0x6A80;
+    }
+#endif
+    return lastSignature.valid ? 0x6A80 : 0x6985;
+}
+
 uint32_t sign_hash_and_set_result(void) {
     // store hash
     CX_ASSERT(cx_hash_no_throw(&sha256.header,
@@ -210,109 +491,333 @@ uint32_t sign_hash_and_set_result(void) {
                                tmpCtx.transactionContext.hash,
                                sizeof(tmpCtx.transactionContext.hash)));
 
+    return sign_digest_and_set_result();
+}
+
+static void derive_private_key(const uint32_t *bip32Path,
+                               uint8_t bip32PathLength,
+                               cx_ecfp_private_key_t *privateKey) {
     uint8_t privateKeyData[64];
-    cx_ecfp_private_key_t privateKey;
-    uint32_t tx = 0;
-    uint8_t V[33];
-    uint8_t K[32];
-    int tries = 0;
 
     CX_ASSERT(os_derive_bip32_no_throw(CX_CURVE_256K1,
-                                       tmpCtx.transactionContext.bip32Path,
-                                       tmpCtx.transactionContext.pathLength,
+                                       bip32Path,
+                                       bip32PathLength,
                                        privateKeyData,
                                        NULL));
-    CX_ASSERT(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1, privateKeyData, 32, &privateKey));
+    CX_ASSERT(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1, privateKeyData, 32, privateKey));
     memset(privateKeyData, 0, sizeof(privateKeyData));
+}
+
+/**
+ * Derive the signing key of the transaction path, unless it is already derived.
+ */
+static void load_signing_key(void) {
+    if (signingKey.valid && signingKey.pathLength == tmpCtx.transactionContext.pathLength &&
+        memcmp(signingKey.bip32Path,
+               tmpCtx.transactionContext.bip32Path,
+               signingKey.pathLength * sizeof(uint32_t)) == 0) {
+        return;
+    }
+    wipe_signing_key();
+    derive_private_key(tmpCtx.transactionContext.bip32Path,
+                       tmpCtx.transactionContext.pathLength,
+                       &signingKey.privateKey);
 
-    // Loop until a candidate matching the canonical signature is found
+    signingKey.pathLength = tmpCtx.transactionContext.pathLength;
+    memmove(signingKey.bip32Path,
+            tmpCtx.transactionContext.bip32Path,
+            sizeof(signingKey.bip32Path));
+    signingKey.valid = true;
+}
+
+/**
+ * Sign the digest as a compact signature: recovery header byte, r and s. The RFC 6979
+ * candidates are tried in turn until the signature is canonical for EOS. Return the
+ * number of rejected candidates.
+ */
+static uint32_t sign_canonical(const cx_ecfp_private_key_t *privateKey,
+                               const uint8_t *hash,
+                               uint8_t *signature) {
+    rfc6979_state_t drbg;
+    uint8_t *r = signature + 1;
+    uint8_t *s = signature + 1 + 32;
+    uint32_t tries = 0;
+    uint32_t infos;
 
     for (;;) {
-        if (tries == 0) {
-            rng_rfc6979(G_io_apdu_buffer + 100,
-                        tmpCtx.transactionContext.hash,
-                        privateKey.d,
-                        privateKey.d_len,
-                        SECP256K1_N,
-                        32,
-                        V,
-                        K);
-        } else {
-            rng_rfc6979(G_io_apdu_buffer + 100,
-                        tmpCtx.transactionContext.hash,
-                        NULL,
-                        0,
-                        SECP256K1_N,
-                        32,
-                        V,
-                        K);
-        }
-        uint32_t infos;
-        uint32_t sig_len = 100;
-        CX_ASSERT(cx_ecdsa_sign_no_throw(&privateKey,
-                                         CX_NO_CANONICAL | CX_RND_PROVIDED | CX_LAST,
-                                         CX_SHA256,
-                                         tmpCtx.transactionContext.hash,
-                                         32,
-                                         G_io_apdu_buffer + 100,
-                                         &sig_len,
-                                         &infos));
-        if ((infos & CX_ECCINFO_PARITY_ODD) != 0) {
-            G_io_apdu_buffer[100] |= 0x01;
-        }
-        G_io_apdu_buffer[0] = 27 + 4 + (G_io_apdu_buffer[100] & 0x01);
-        ecdsa_der_to_sig(G_io_apdu_buffer + 100, G_io_apdu_buffer + 1);
-        if (check_canonical(G_io_apdu_buffer + 1)) {
-            tx = 1 + 64;
+        // The nonce is provided in place of r
+        rng_rfc6979(r,
+                    hash,
+                    tries == 0 ? privateKey->d : NULL,
+                    tries == 0 ? privateKey->d_len : 0,
+                    SECP256K1_N,
+                    32,
+                    &drbg);
+        CX_ASSERT(cx_ecdsa_sign_rs_no_throw(privateKey,
+                                            CX_NO_CANONICAL | CX_RND_PROVIDED | CX_LAST,
+                                            CX_SHA256,
+                                            hash,
+                                            32,
+                                            32,
+                                            r,
+                                            s,
+                                            &infos));
+        if (check_canonical(r)) {
             break;
-        } else {
-            tries++;
         }
+        tries++;
     }
+    explicit_bzero(&drbg, sizeof(drbg));
 
-    memset(&privateKey, 0, sizeof(privateKey));
+    signature[0] = 27 + 4 + ((infos & CX_ECCINFO_PARITY_ODD) != 0 ? 1 : 0);
+    return tries;
+}
+
+/**
+ * Sign the transaction digest with the key of each of its paths, in order.
+ */
+uint32_t sign_digest_and_set_result(void) {
+    cx_ecfp_private_key_t privateKey;
+    uint32_t tx = SIGNATURE_LENGTH;
+    uint8_t i;
+
+    // Derived when the transaction started, unless it was wiped since
+    load_signing_key();
+
+    tmpCtx.transactionContext.rejectedCandidates =
+        sign_canonical(&signingKey.privateKey, tmpCtx.transactionContext.hash, G_io_apdu_buffer);
+    for (i = 0; i < tmpCtx.transactionContext.additionalPathCount; i++) {
+        derive_private_key(tmpCtx.transactionContext.additionalBip32Path[i],
+                           tmpCtx.transactionContext.additionalPathLength[i],
+                           &privateKey);
+        tmpCtx.transactionContext.rejectedCandidates +=
+            sign_canonical(&privateKey, tmpCtx.transactionContext.hash, G_io_apdu_buffer + tx);
+        explicit_bzero(&privateKey, sizeof(privateKey));
+        tx += SIGNATURE_LENGTH;
+    }
+    PRINTF("Canonical signatures after %d rejected candidates\n",
+           tmpCtx.transactionContext.rejectedCandidates);
+
+    if (!tmpCtx.transactionContext.cacheSigningKey) {
+        wipe_signing_key();
+    }
+
+    memmove(lastSignature.hash, tmpCtx.transactionContext.hash, sizeof(lastSignature.hash));
+    memmove(lastSignature.signatures, G_io_apdu_buffer, tx);
+    lastSignature.length = tx;
+    lastSignature.valid = true;
 
     return tx;
 }
 
-uint32_t handleSign(uint8_t p1,
-                    uint8_t p2,
-                    uint8_t *workBuffer,
-                    uint16_t dataLength,
-                    volatile unsigned int *flags,
-                    volatile unsigned int *tx) {
+/**
+ * Read a BIP 32 path: its number of derivations followed by the big endian indexes.
+ */
+static bool read_bip32_path(uint8_t **buffer,
+                            uint16_t *length,
+                            uint8_t *bip32PathLength,
+                            uint32_t *bip32Path) {
+    uint8_t *in = *buffer;
     uint32_t i;
-    parserStatus_e txResult;
-    if (p1 == P1_FIRST) {
-        tmpCtx.transactionContext.pathLength = workBuffer[0];
-        if ((tmpCtx.transactionContext.pathLength < 0x01) ||
-            (tmpCtx.transactionContext.pathLength > MAX_BIP32_PATH)) {
+
+    if ((*length < 1) || (in[0] < 0x01) || (in[0] > MAX_BIP32_PATH) ||
+        (*length < 1 + 4 * in[0])) {
+        return false;
+    }
+    *bip32PathLength = *(in++);
+    for (i = 0; i < *bip32PathLength; i++) {
+        bip32Path[i] = (in[0] << 24) | (in[1] << 16) | (in[2] << 8) | (in[3]);
+        in += 4;
+    }
+    *length -= in - *buffer;
+    *buffer = in;
+    return true;
+}
+
+/**
+ * Start a transaction from its first block: read its signing paths and initialize
+ * the parser.
+ */
+static uint32_t start_transaction(uint8_t p2, uint8_t **workBuffer, uint16_t *dataLength) {
+    reviewQueue_t *reviewQueue = NULL;
+    uint8_t pathCount = 1;
+    uint32_t i;
+
+    clear_last_signature();
+#ifdef HAVE_REVIEW_QUEUE
+    if ((p2 & P2_REVIEW_AFTER_STREAM) != 0) {
+        reviewQueue = &tmpCtx.transactionContext.reviewQueue;
+    }
+#endif
+    if ((p2 & P2_MULTIPLE_PATHS) != 0) {
+        // The transaction is signed with the key of each path
+        if ((*dataLength < 1) || (**workBuffer < 1) || (**workBuffer > MAX_SIGNING_PATHS)) {
+            return 0x6a80;
+        }
+        pathCount = *((*workBuffer)++);
+        (*dataLength)--;
+    }
+    if (!read_bip32_path(workBuffer,
+                         dataLength,
+                         &tmpCtx.transactionContext.pathLength,
+                         tmpCtx.transactionContext.bip32Path)) {
+        PRINTF("Invalid path\n");
+        return 0x6a80;
+    }
+    tmpCtx.transactionContext.additionalPathCount = pathCount - 1;
+    for (i = 0; i < tmpCtx.transactionContext.additionalPathCount; i++) {
+        if (!read_bip32_path(workBuffer,
+                             dataLength,
+                             &tmpCtx.transactionContext.additionalPathLength[i],
+                             tmpCtx.transactionContext.additionalBip32Path[i])) {
             PRINTF("Invalid path\n");
             return 0x6a80;
         }
-        workBuffer++;
-        dataLength--;
-        for (i = 0; i < tmpCtx.transactionContext.pathLength; i++) {
-            tmpCtx.transactionContext.bip32Path[i] = (workBuffer[0] << 24) | (workBuffer[1] << 16) |
-                                                     (workBuffer[2] << 8) | (workBuffer[3]);
-            workBuffer += 4;
-            dataLength -= 4;
+    }
+    tmpCtx.transactionContext.cacheSigningKey = (p2 & P2_CACHE_SIGNING_KEY) != 0;
+    if (!tmpCtx.transactionContext.cacheSigningKey) {
+        wipe_signing_key();
+    }
+    load_signing_key();
+    initTxContext(&txProcessingCtx,
+                  &sha256,
+                  &dataSha256,
+                  &txContent,
+                  is_data_allowed() ? 0x01 : 0x00,
+                  (p2 & P2_PACKED_TRANSACTION) != 0,
+                  reviewQueue);
+    return SWO_SUCCESS;
+}
+
+#ifdef HAVE_BATCH_SIGNING
+/**
+ * Start a transaction of a batch. The first block starts with the index of the
+ * transaction in the batch. The first transaction also gives the number of transactions
+ * and the signing path, the next ones are signed with the same path and options.
+ */
+static uint32_t start_batch_transaction(uint8_t p2, uint8_t **workBuffer, uint16_t *dataLength) {
+    uint8_t index;
+    uint8_t count;
+    uint32_t sw;
+
+    if (*dataLength < 1) {
+        return 0x6a80;
+    }
+    index = *((*workBuffer)++);
+    (*dataLength)--;
+    if (index == 0) {
+        if ((*dataLength < 1) || (**workBuffer < 1) || (**workBuffer > BATCH_MAX_TRANSACTIONS)) {
+            return 0x6a80;
+        }
+        count = *((*workBuffer)++);
+        (*dataLength)--;
+        sw = start_transaction(p2, workBuffer, dataLength);
+        if (sw != SWO_SUCCESS) {
+            return sw;
+        }
+        batchSession.transactionCount = count;
+        batchSession.cacheSigningKey = tmpCtx.transactionContext.cacheSigningKey;
+        batchSession.pathLength = tmpCtx.transactionContext.pathLength;
+        memmove(batchSession.bip32Path,
+                tmpCtx.transactionContext.bip32Path,
+                sizeof(batchSession.bip32Path));
+    } else {
+        if ((batchSession.transactionCount == 0) || batchSession.approved ||
+            (index != batchSession.streamedCount)) {
+            return 0x6a80;
         }
         initTxContext(&txProcessingCtx,
                       &sha256,
                       &dataSha256,
                       &txContent,
-                      is_data_allowed() ? 0x01 : 0x00);
-    } else if (p1 != P1_MORE) {
+                      is_data_allowed() ? 0x01 : 0x00,
+                      (p2 & P2_PACKED_TRANSACTION) != 0,
+                      NULL);
+    }
+    txProcessingCtx.batch = &batchSession.summary;
+    return SWO_SUCCESS;
+}
+
+/**
+ * Keep the digest of a streamed transaction of the batch. The batch is reviewed once
+ * its last transaction is streamed.
+ */
+static uint32_t finish_batch_transaction(volatile unsigned int *flags) {
+    CX_ASSERT(cx_hash_no_throw(&sha256.header,
+                               CX_LAST,
+                               NULL,
+                               0,
+                               batchSession.hashes[batchSession.streamedCount],
+                               sizeof(batchSession.hashes[0])));
+    batchSession.streamedCount++;
+    if (batchSession.streamedCount < batchSession.transactionCount) {
+        return SWO_SUCCESS;
+    }
+    batchSession.summary.transactionCount = batchSession.transactionCount;
+    if (!startBatchReview(&txProcessingCtx)) {
+        return 0x6A80;
+    }
+    ui_display_single_action_sign_flow();
+    *flags |= IO_ASYNCH_REPLY;
+    return SWO_SUCCESS;
+}
+#endif
+
+static uint32_t handleSignChunk(uint8_t p1,
+                                uint8_t p2,
+                                uint8_t *workBuffer,
+                                uint16_t dataLength,
+                                volatile unsigned int *flags,
+                                volatile unsigned int *tx) {
+    uint32_t sw;
+    parserStatus_e txResult;
+    bool packed = (p2 & P2_PACKED_TRANSACTION) != 0;
+    bool reviewAfterStream = (p2 & P2_REVIEW_AFTER_STREAM) != 0;
+    bool batchMode = (p2 & P2_BATCH) != 0;
+    if ((p2 & ~(P2_PACKED_TRANSACTION | P2_REVIEW_AFTER_STREAM | P2_CACHE_SIGNING_KEY |
+                P2_MULTIPLE_PATHS | P2_BATCH)) != 0) {
         return 0x6B00;
     }
-    if (p2 != 0) {
+#ifndef HAVE_REVIEW_QUEUE
+    if (reviewAfterStream) {
+        return 0x6B00;
+    }
+#endif
+#ifndef HAVE_BATCH_SIGNING
+    if (batchMode) {
+        return 0x6B00;
+    }
+#endif
+    // A batch is reviewed at once and signed with a single path
+    if (batchMode && (p2 & (P2_REVIEW_AFTER_STREAM | P2_MULTIPLE_PATHS)) != 0) {
+        return 0x6B00;
+    }
+    if (p1 == P1_FIRST) {
+#ifdef HAVE_BATCH_SIGNING
+        if (batchMode) {
+            sw = start_batch_transaction(p2, &workBuffer, &dataLength);
+        } else {
+            sw = start_transaction(p2, &workBuffer, &dataLength);
+        }
+#else
+        sw = start_transaction(p2, &workBuffer, &dataLength);
+#endif
+        if (sw != SWO_SUCCESS) {
+            return sw;
+        }
+    } else if (p1 != P1_MORE) {
         return 0x6B00;
     }
     if (txProcessingCtx.state == TLV_NONE) {
         PRINTF("Parser not initialized\n");
         return 0x6985;
     }
+    if (txProcessingCtx.packed != packed ||
+        (txProcessingCtx.reviewQueue != NULL) != reviewAfterStream ||
+        (txProcessingCtx.batch != NULL) != batchMode) {
+        // Encoding and review mode can't change in the middle of a transaction
+        return 0x6B00;
+    }
 
     txResult = parseTx(&txProcessingCtx, workBuffer, dataLength);
     switch (txResult) {
@@ -325,7 +830,24 @@ uint32_t handleSign(uint8_t p1,
             *flags |= IO_ASYNCH_REPLY;
             break;
         case STREAM_FINISHED:
-            *tx = sign_hash_and_set_result();
+#ifdef HAVE_BATCH_SIGNING
+            if (txProcessingCtx.batch != NULL) {
+                return finish_batch_transaction(flags);
+            }
+#endif
+            if (txProcessingCtx.reviewQueue == NULL || txProcessingCtx.currentActionNumber == 0) {
+                *tx = sign_hash_and_set_result();
+                break;
+            }
+            // The whole transaction is streamed, review its actions back to back
+            startQueuedReview(&txProcessingCtx);
+            if (txProcessingCtx.currentActionNumber > 1) {
+                ui_display_multiple_action_sign_flow();
+            } else {
+                reviewNextQueuedAction(&txProcessingCtx);
+                ui_display_single_action_sign_flow();
+            }
+            *flags |= IO_ASYNCH_REPLY;
             break;
         case STREAM_PROCESSING:
             break;
@@ -338,6 +860,94 @@ uint32_t handleSign(uint8_t p1,
     return SWO_SUCCESS;
 }
 
+/**
+ * Answer again to the last sequenced chunk. The final chunk is answered with the
+ * signature of the same digest, which is deterministic.
+ */
+static uint32_t handleSignRetransmission(volatile unsigned int *tx) {
+    if (signSequence.status == 0) {
+        return 0x6985;
+    }
+    // The transactions of a batch are answered without their signature
+    if (signSequence.status == SWO_SUCCESS && txProcessingCtx.state == TLV_DONE &&
+        txProcessingCtx.batch == NULL) {
+        *tx = sign_digest_and_set_result();
+    }
+    return signSequence.status;
+}
+
+uint32_t handleSign(uint8_t p1,
+                    uint8_t p2,
+                    uint8_t *workBuffer,
+                    uint16_t dataLength,
+                    volatile unsigned int *flags,
+                    volatile unsigned int *tx) {
+    uint32_t sw;
+
+    if ((p2 & P2_SEQUENCED_CHUNKS) == 0) {
+        if (p1 == P1_FIRST) {
+            signSequence.enabled = false;
+        } else if (signSequence.enabled) {
+            // Sequencing can't change in the middle of a transaction
+            return 0x6B00;
+        }
+        sw = handleSignChunk(p1, p2, workBuffer, dataLength, flags, tx);
+        if (sw != SWO_SUCCESS) {
+            wipe_signing_key();
+            clear_last_signature();
+        }
+        return sw;
+    }
+
+    if (dataLength < SIGN_CHUNK_HEADER_LENGTH) {
+        return 0x6A80;
+    }
+    uint16_t sequence = (workBuffer[0] << 8) | workBuffer[1];
+    uint32_t offset =
+        (workBuffer[2] << 24) | (workBuffer[3] << 16) | (workBuffer[4] << 8) | workBuffer[5];
+    workBuffer += SIGN_CHUNK_HEADER_LENGTH;
+    dataLength -= SIGN_CHUNK_HEADER_LENGTH;
+    uint32_t crc = cx_crc32(workBuffer, dataLength);
+
+    if ((p1 == P1_FIRST) != (sequence == 0)) {
+        return 0x6A80;
+    }
+    if (signSequence.enabled && sequence == signSequence.sequence &&
+        offset == signSequence.offset && dataLength == signSequence.length &&
+        crc == signSequence.crc) {
+        return handleSignRetransmission(tx);
+    }
+    if (p1 != P1_FIRST) {
+        if (!signSequence.enabled) {
+            // Sequencing can't change in the middle of a transaction
+            return 0x6B00;
+        }
+        if (sequence != (uint16_t) (signSequence.sequence + 1) ||
+            offset != signSequence.offset + signSequence.length) {
+            PRINTF("Unexpected chunk\n");
+            return 0x6A80;
+        }
+    } else if (offset != 0) {
+        return 0x6A80;
+    }
+
+    signSequence.enabled = true;
+    signSequence.sequence = sequence;
+    signSequence.offset = offset;
+    signSequence.length = dataLength;
+    signSequence.crc = crc;
+    signSequence.status = 0;
+    sw = handleSignChunk(p1, p2 & ~P2_SEQUENCED_CHUNKS, workBuffer, dataLength, flags, tx);
+    if ((*flags & IO_ASYNCH_REPLY) == 0) {
+        signSequence.status = sw;
+    }
+    if (sw != SWO_SUCCESS) {
+        wipe_signing_key();
+        clear_last_signature();
+    }
+    return sw;
+}
+
 uint32_t handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
     uint32_t sw = EXCEPTION;
 
@@ -364,6 +974,15 @@ uint32_t handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
                             tx);
             break;
 
+        case INS_GET_PUBLIC_KEYS:
+            sw = handleGetPublicKeys(G_io_apdu_buffer[OFFSET_P1],
+                                     G_io_apdu_buffer[OFFSET_P2],
+                                     G_io_apdu_buffer + OFFSET_CDATA,
+                                     G_io_apdu_buffer[OFFSET_LC],
+                                     flags,
+                                     tx);
+            break;
+
         case INS_GET_APP_CONFIGURATION:
             sw = handleGetAppConfiguration(G_io_apdu_buffer[OFFSET_P1],
                                            G_io_apdu_buffer[OFFSET_P2],
@@ -373,6 +992,15 @@ uint32_t handleApdu(volatile unsigned int *flags, volatile unsigned int *tx) {
                                            tx);
             break;
 
+        case INS_GET_LAST_SIGNATURE:
+            sw = handleGetLastSignature(G_io_apdu_buffer[OFFSET_P1],
+                                        G_io_apdu_buffer[OFFSET_P2],
+                                        G_io_apdu_buffer + OFFSET_CDATA,
+                                        G_io_apdu_buffer[OFFSET_LC],
+                                        flags,
+                                        tx);
+            break;
+
         default:
             sw = 0x6D00;
             break;
@@ -408,12 +1036,16 @@ void app_main(void) {
                 // no apdu received, well, reset the session, and reset the
                 // bootloader configuration
                 if (rx == 0) {
+                    wipe_signing_key();
+                    clear_last_signature();
                     sw = 0x6982;
                 } else {
                     sw = handleApdu(&flags, &tx);
                 }
             }
             CATCH_OTHER(e) {
+                wipe_signing_key();
+                clear_last_signature();
                 switch (e & 0xF000) {
                     case EXCEPTION_IO_RESET:
                     case 0x6000:
@@ -17,18 +17,37 @@
 #include "eos_stream.h"
 
 #define MAX_BIP32_PATH 10
+// Paths signing a transaction, their signatures must fit in a response
+#define MAX_SIGNING_PATHS 3
 
 typedef struct publicKeyContext_t {
     cx_ecfp_public_key_t publicKey;
     char address[60];
     uint8_t chainCode[32];
     bool getChaincode;
+    // Return the compressed public key and the chain code only
+    bool extended;
 } publicKeyContext_t;
 
 typedef struct transactionContext_t {
     uint8_t pathLength;
     uint32_t bip32Path[MAX_BIP32_PATH];
+    // Other paths signing the same transaction
+    uint8_t additionalPathCount;
+    uint8_t additionalPathLength[MAX_SIGNING_PATHS - 1];
+    uint32_t additionalBip32Path[MAX_SIGNING_PATHS - 1][MAX_BIP32_PATH];
     uint8_t hash[32];
+    // Keep the signing key for the next transactions on the same path
+    bool cacheSigningKey;
+    // Candidate signatures rejected as not canonical, over all the paths of the last
+    // signed transaction
+    uint32_t rejectedCandidates;
+#ifdef HAVE_REVIEW_CACHE
+    reviewCache_t reviewCache;
+#endif
+#ifdef HAVE_REVIEW_QUEUE
+    reviewQueue_t reviewQueue;
+#endif
 } transactionContext_t;
 
 typedef union sharedContext_t {
@@ -44,3 +63,6 @@ unsigned int user_action_tx_cancel(void);
 unsigned int user_action_address_ok(void);
 unsigned int user_action_address_cancel(void);
 void user_action_sign_flow_ok(void);
+void wipe_signing_key(void);
+void clear_last_signature(void);
+void quit_app(void);
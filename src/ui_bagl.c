@@ -64,7 +64,7 @@ UX_STEP_CB(ux_idle_flow_3_step,
            });
 UX_STEP_CB(ux_idle_flow_4_step,
            pb,
-           os_sched_exit(-1),
+           quit_app(),
            {
                &C_icon_dashboard_x,
                "Quit",
@@ -254,6 +254,18 @@ static void display_next_state(uint8_t state) {
             ux_flow_next();
         }
     } else if (state == STATE_VARIABLE) {
+#ifdef HAVE_REVIEW_CACHE
+        const char *label = NULL;
+        const char *data = NULL;
+        if (getReviewCacheArgument(&tmpCtx.transactionContext.reviewCache,
+                                   ux_step - 1,
+                                   &label,
+                                   &data)) {
+            strlcpy(txContent.arg.label, label, sizeof(txContent.arg.label));
+            strlcpy(txContent.arg.data, data, sizeof(txContent.arg.data));
+            return;
+        }
+#endif
         printArgument(ux_step - 1, &txProcessingCtx);
     } else if (state == STATE_RIGHT_BORDER) {
         if (ux_step < ux_step_count) {
@@ -272,6 +284,9 @@ static void display_next_state(uint8_t state) {
 void ui_display_single_action_sign_flow(void) {
     ux_step = 0;
     ux_step_count = txContent.argumentCount;
+#ifdef HAVE_REVIEW_CACHE
+    fillReviewCache(&txProcessingCtx, &tmpCtx.transactionContext.reviewCache);
+#endif
 
     if (txProcessingCtx.currentActionNumber > 1) {
         snprintf(confirmLabel,
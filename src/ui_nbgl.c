@@ -32,8 +32,6 @@
 #include "config.h"
 #include "eos_parse.h"
 
-void app_exit(void);
-
 static nbgl_contentSwitch_t switches[1] = {0};
 static const char* const INFO_TYPES[] = {"Version"};
 static const char* const INFO_CONTENTS[] = {APPVERSION};
@@ -79,7 +77,7 @@ void ui_idle(void) {
                                 &settingContents,
                                 &infosList,
                                 NULL,
-                                app_exit);
+                                quit_app);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -126,6 +124,15 @@ static nbgl_contentTagValue_t* get_single_action_review_pair(uint8_t index) {
         pair.item = "Action";
         pair.value = txContent.action;
     } else {
+#ifdef HAVE_REVIEW_CACHE
+        // The cached strings stay valid for the whole action review
+        if (getReviewCacheArgument(&tmpCtx.transactionContext.reviewCache,
+                                   index - 2,
+                                   &pair.item,
+                                   &pair.value)) {
+            return &pair;
+        }
+#endif
         // Retrieve action argument, with an index to action args offset
         printArgument(index - 2, &txProcessingCtx);
 
@@ -183,6 +190,9 @@ static void review_choice_multi(bool confirm) {
 
 void ui_display_single_action_sign_flow(void) {
     explicit_bzero(&pairList, sizeof(pairList));
+#ifdef HAVE_REVIEW_CACHE
+    fillReviewCache(&txProcessingCtx, &tmpCtx.transactionContext.reviewCache);
+#endif
 
     if (txProcessingCtx.currentActionNumber == 1) {
         pairList.nbPairs = txContent.argumentCount + 2;
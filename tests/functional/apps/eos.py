@@ -1,6 +1,6 @@
 from contextlib import contextmanager
 from enum import IntEnum
-from typing import Generator, Optional, Tuple
+from typing import Generator, List, Optional, Tuple
 from pycoin.ecdsa.secp256k1 import secp256k1_generator  # type: ignore
 
 from bip_utils.addr import EosAddrEncoder  # type: ignore
@@ -20,6 +20,8 @@ class INS(IntEnum):
     INS_GET_PUBLIC_KEY = 0x02
     INS_SIGN_MESSAGE = 0x04
     INS_GET_APP_CONFIGURATION = 0x06
+    INS_GET_PUBLIC_KEYS = 0x08
+    INS_GET_LAST_SIGNATURE = 0x0A
 
 
 CLA = 0xD4
@@ -29,10 +31,22 @@ P1_CONFIRM = 0x01
 
 P2_NO_CHAINCODE = 0x00
 P2_CHAINCODE = 0x01
+P2_EXTENDED_PUBLIC_KEY = 0x02
+
+P2_NO_ADDRESS = 0x00
+P2_ADDRESS = 0x01
 
 P1_FIRST = 0x00
 P1_MORE = 0x80
 
+P2_TLV_TRANSACTION = 0x00
+P2_PACKED_TRANSACTION = 0x01
+P2_SEQUENCED_CHUNKS = 0x02
+P2_REVIEW_AFTER_STREAM = 0x04
+P2_CACHE_SIGNING_KEY = 0x08
+P2_MULTIPLE_PATHS = 0x10
+P2_BATCH = 0x20
+
 MAX_CHUNK_SIZE = 255
 
 STATUS_OK = 0x9000
@@ -89,6 +103,9 @@ class EosClient:
     def compute_adress_from_public_key(self, public_key: bytes) -> str:
         return EosAddrEncoder.EncodeKey(public_key)
 
+    def compress_public_key(self, public_key: bytes) -> bytes:
+        return bytes([0x03 if public_key[64] & 1 else 0x02]) + public_key[1:33]
+
     def parse_get_public_key_response(self, response: bytes, request_chaincode: bool) -> Tuple[bytes, str, Optional[bytes]]:
         # response = public_key_len (1) ||
         #            public_key (var) ||
@@ -124,6 +141,44 @@ class EosClient:
         return self._client.exchange(CLA, INS.INS_GET_PUBLIC_KEY,
                                      p1, p2, payload)
 
+    def send_get_extended_public_key_non_confirm(self, derivation_path: str) -> Tuple[bytes, bytes]:
+        # response = compressed_public_key (33) || chain_code (32)
+        payload = pack_derivation_path(derivation_path)
+        response = self._client.exchange(CLA, INS.INS_GET_PUBLIC_KEY,
+                                         P1_NON_CONFIRM, P2_EXTENDED_PUBLIC_KEY, payload).data
+        assert len(response) == 33 + 32
+        return response[:33], response[33:]
+
+    def send_get_public_keys(self, base_path: str, start_index: int, count: int,
+                             request_address: bool) -> RAPDU:
+        p2 = P2_ADDRESS if request_address else P2_NO_ADDRESS
+        payload = pack_derivation_path(base_path) + start_index.to_bytes(4, "big") + bytes([count])
+        return self._client.exchange(CLA, INS.INS_GET_PUBLIC_KEYS,
+                                     P1_NON_CONFIRM, p2, payload)
+
+    def send_get_last_signature(self, signing_digest: bytes) -> RAPDU:
+        return self._client.exchange(CLA, INS.INS_GET_LAST_SIGNATURE, 0x00, 0x00, signing_digest)
+
+    def parse_get_public_keys_response(self, response: bytes,
+                                       request_address: bool) -> List[Tuple[bytes, Optional[str]]]:
+        # response = count (1) ||
+        #            count * (compressed_public_key (33) ||
+        #                     [address_len (1) || address (var)])
+        keys = []
+        offset = 1
+        for _ in range(response[0]):
+            public_key = response[offset:offset + 33]
+            offset += 33
+            address = None
+            if request_address:
+                address_len = response[offset]
+                address = response[offset + 1:offset + 1 + address_len].decode("ascii")
+                offset += 1 + address_len
+                assert self.compute_adress_from_public_key(public_key) == address
+            keys.append((public_key, address))
+        assert len(response) == offset
+        return keys
+
     @contextmanager
     def send_async_get_public_key_confirm(self, derivation_path: str,
                                           request_chaincode: bool) -> Generator[None, None, None]:
@@ -134,37 +189,107 @@ class EosClient:
                                          p1, p2, payload):
             yield
 
-    def _send_sign_message(self, message: bytes, first: bool) -> RAPDU:
+    def _send_sign_message(self, message: bytes, first: bool,
+                           p2: int = P2_TLV_TRANSACTION) -> RAPDU:
         if first:
             p1 = P1_FIRST
         else:
             p1 = P1_MORE
-        return self._client.exchange(CLA, INS.INS_SIGN_MESSAGE, p1, 0, message)
+        return self._client.exchange(CLA, INS.INS_SIGN_MESSAGE, p1, p2, message)
 
     @contextmanager
     def send_async_sign_message_full(self, message: bytes,
-                                 first: bool) -> Generator[None, None, None]:
+                                 first: bool,
+                                 p2: int = P2_TLV_TRANSACTION) -> Generator[None, None, None]:
         if first:
             p1 = P1_FIRST
         else:
             p1 = P1_MORE
-        with self._client.exchange_async(CLA, INS.INS_SIGN_MESSAGE, p1, 0, message):
+        with self._client.exchange_async(CLA, INS.INS_SIGN_MESSAGE, p1, p2, message):
             yield
 
     def send_async_sign_message(self,
                                 derivation_path: str,
-                                message: bytes):
+                                message: bytes,
+                                packed: bool = False,
+                                review_after_stream: bool = False,
+                                cache_signing_key: bool = False,
+                                additional_paths: Optional[List[str]] = None):
+        # message is the DER encoded transaction, or the packed one if packed is set
+        p2 = P2_PACKED_TRANSACTION if packed else P2_TLV_TRANSACTION
+        if review_after_stream:
+            p2 |= P2_REVIEW_AFTER_STREAM
+        if cache_signing_key:
+            p2 |= P2_CACHE_SIGNING_KEY
         payload = pack_derivation_path(derivation_path) + message
+        if additional_paths:
+            # The transaction is signed with the key of each path, in order
+            p2 |= P2_MULTIPLE_PATHS
+            paths = [derivation_path] + additional_paths
+            payload = bytes([len(paths)]) + b"".join(pack_derivation_path(p) for p in paths) + message
         messages = split_message(payload, MAX_CHUNK_SIZE)
         first = True
 
         if len(messages) > 1:
-            self._send_sign_message(messages[0], True)
+            self._send_sign_message(messages[0], True, p2)
             for m in messages[1:-1]:
-                self._send_sign_message(m, False)
+                self._send_sign_message(m, False, p2)
             first = False
 
-        return self.send_async_sign_message_full(messages[-1], first)
+        return self.send_async_sign_message_full(messages[-1], first, p2)
+
+    def send_rejected_sign_message(self, derivation_path: str, message: bytes) -> RAPDU:
+        # Send the blocks of a transaction rejected before its review, until the first
+        # failed one
+        messages = split_message(pack_derivation_path(derivation_path) + message,
+                                 MAX_CHUNK_SIZE)
+        for i, m in enumerate(messages):
+            rapdu = self._send_sign_message(m, i == 0)
+            if rapdu.status != STATUS_OK:
+                break
+        return rapdu
+
+    def split_sequenced_message(self, derivation_path: str, message: bytes,
+                                chunk_size: int = MAX_CHUNK_SIZE - 6) -> List[Tuple[int, bytes]]:
+        # Each chunk is prefixed with its sequence number and offset, return (p1, chunk) pairs
+        payload = pack_derivation_path(derivation_path) + message
+        chunks = []
+        for offset in range(0, len(payload), chunk_size):
+            header = (offset // chunk_size).to_bytes(2, "big") + offset.to_bytes(4, "big")
+            p1 = P1_FIRST if offset == 0 else P1_MORE
+            chunks.append((p1, header + payload[offset:offset + chunk_size]))
+        return chunks
+
+    def send_sequenced_chunk(self, p1: int, chunk: bytes) -> RAPDU:
+        return self._client.exchange(CLA, INS.INS_SIGN_MESSAGE, p1,
+                                     P2_TLV_TRANSACTION | P2_SEQUENCED_CHUNKS, chunk)
+
+    @contextmanager
+    def send_async_sequenced_chunk(self, p1: int, chunk: bytes) -> Generator[None, None, None]:
+        with self._client.exchange_async(CLA, INS.INS_SIGN_MESSAGE, p1,
+                                         P2_TLV_TRANSACTION | P2_SEQUENCED_CHUNKS, chunk):
+            yield
+
+    def send_batch_chunk(self, p1: int, chunk: bytes) -> RAPDU:
+        return self._client.exchange(CLA, INS.INS_SIGN_MESSAGE, p1,
+                                     P2_TLV_TRANSACTION | P2_BATCH, chunk)
+
+    def split_batch_message(self, derivation_path: str, index: int, count: int,
+                            message: bytes) -> List[Tuple[int, bytes]]:
+        # The first block of each transaction starts with its index in the batch, the one
+        # of the first transaction then gives the number of transactions and the path
+        payload = bytes([index])
+        if index == 0:
+            payload += bytes([count]) + pack_derivation_path(derivation_path)
+        payload += message
+        return [(P1_FIRST if i == 0 else P1_MORE, chunk)
+                for i, chunk in enumerate(split_message(payload, MAX_CHUNK_SIZE))]
+
+    @contextmanager
+    def send_async_batch_chunk(self, p1: int, chunk: bytes) -> Generator[None, None, None]:
+        with self._client.exchange_async(CLA, INS.INS_SIGN_MESSAGE, p1,
+                                         P2_TLV_TRANSACTION | P2_BATCH, chunk):
+            yield
 
     def get_async_response(self) -> RAPDU:
         return self._client.last_async_response
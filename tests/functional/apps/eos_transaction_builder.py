@@ -50,6 +50,9 @@ def symbol_precision(sym):
 
 def encode_asset(asset):
     amount_str, symol_str = asset.split(' ')
+    negative = amount_str.startswith('-')
+    if negative:
+        amount_str = amount_str[1:]
     dot_pos = amount_str.find('.')
 
     # parse symbol
@@ -60,20 +63,12 @@ def encode_asset(asset):
 
     sym = symbol_from_string(precision_digit, symol_str)
 
-    # parse amount
-    if dot_pos != -1:
-        int_part = int(amount_str[:dot_pos])
-        fract_part = int(amount_str[dot_pos+1:])
-        if int_part < 0:
-            fract_part *= -1
-    else:
-        int_part = int(amount_str)
+    # parse amount, the digits with the point removed are the amount in the smallest unit
+    amount = int(amount_str.replace('.', ''))
+    if negative:
+        amount *= -1
 
-    amount = int_part
-    amount *= symbol_precision(sym)
-    amount += fract_part
-
-    data = pack('Q', amount)
+    data = pack('q', amount)
     data += pack('Q', sym)
     return data
 
@@ -85,7 +80,7 @@ def encode_fc_uint(value):
         b = val & 0x7f
         val >>= 7
         b |= ((val > 0) << 7)
-        out += chr(b).encode()
+        out += bytes([b])
 
         if val == 0:
             break
@@ -302,6 +297,14 @@ class TransactionEncoder():
 class Transaction():
 
     def encode(self, json):
+        encoder = self._encode(json)
+        return encoder.digest(), encoder.output()
+
+    def encode_packed(self, json):
+        encoder = self._encode(json)
+        return encoder.digest(), encoder.c
+
+    def _encode(self, json):
         encoder = TransactionEncoder()
         encoder.start()
 
@@ -328,4 +331,4 @@ class Transaction():
         encoder.update(pack('B', len(body['transaction_extensions'])))
         encoder.update(unhexlify('00' * 32))
 
-        return encoder.digest(), encoder.output()
+        return encoder
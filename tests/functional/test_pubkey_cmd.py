@@ -1,10 +1,12 @@
 from ragger.backend import SpeculosBackend
 from ragger.backend.interface import RaisePolicy
+from ragger.bip import pack_derivation_path
 from ragger.bip import calculate_public_key_and_chaincode, CurveChoice
+from bip_utils import Bip32KeyData, Bip32Secp256k1  # type: ignore
 from ragger.backend import BackendInterface
 from ragger.navigator.navigation_scenario import NavigateWithScenario
 
-from apps.eos import EosClient, ErrorType
+from apps.eos import EosClient, ErrorType, CLA, INS, P1_NON_CONFIRM, P2_EXTENDED_PUBLIC_KEY
 
 # Proposed EOS derivation paths for tests ###
 EOS_PATH = "m/44'/194'/12345'"
@@ -33,6 +35,54 @@ def test_get_public_key_non_confirm(backend):
     assert chaincode_2 is None
 
 
+def test_get_extended_public_key_non_confirm(backend):
+    client = EosClient(backend)
+
+    public_key, chaincode = client.send_get_extended_public_key_non_confirm(EOS_PATH)
+    rapdu = client.send_get_public_key_non_confirm(EOS_PATH, True)
+    ref_public_key, _, ref_chaincode = client.parse_get_public_key_response(rapdu.data, True)
+    assert public_key == client.compress_public_key(ref_public_key)
+    assert chaincode == ref_chaincode
+
+    # Non hardened children are derived on the host side
+    account = Bip32Secp256k1.FromPublicKey(public_key, Bip32KeyData(chain_code=chaincode))
+    for index in [0, 5]:
+        rapdu = client.send_get_public_key_non_confirm(f"{EOS_PATH}/{index}", False)
+        child_public_key, _, _ = client.parse_get_public_key_response(rapdu.data, False)
+        child = account.ChildKey(index).PublicKey().RawCompressed().ToBytes()
+        assert child == client.compress_public_key(child_public_key)
+
+    # Extended public keys of non hardened nodes are not exported
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange(CLA, INS.INS_GET_PUBLIC_KEY, P1_NON_CONFIRM, P2_EXTENDED_PUBLIC_KEY,
+                             pack_derivation_path(f"{EOS_PATH}/0"))
+    assert rapdu.status == 0x6A80
+
+
+def test_get_public_keys(backend):
+    client = EosClient(backend)
+    base_path = "m/44'/194'"
+    hardened = 0x80000000
+
+    keys = []
+    while len(keys) < 10:
+        rapdu = client.send_get_public_keys(base_path, hardened + len(keys), 10 - len(keys), False)
+        batch = client.parse_get_public_keys_response(rapdu.data, False)
+        assert len(batch) > 0
+        keys += batch
+    assert len(keys) == 10
+
+    for index, (public_key, _) in enumerate(keys):
+        rapdu = client.send_get_public_key_non_confirm(f"{base_path}/{index}'", False)
+        ref_public_key, address, _ = client.parse_get_public_key_response(rapdu.data, False)
+        assert public_key == client.compress_public_key(ref_public_key)
+        assert client.compute_adress_from_public_key(public_key) == address
+
+    # Addresses are returned on request
+    rapdu = client.send_get_public_keys(base_path, hardened, 2, True)
+    assert client.parse_get_public_keys_response(rapdu.data, True)[0][0] == keys[0][0]
+
+
 def test_get_public_key_confirm_accepted(backend: BackendInterface, scenario_navigator: NavigateWithScenario):
     client = EosClient(backend)
     with client.send_async_get_public_key_confirm(EOS_PATH, True):
@@ -9,7 +9,7 @@ from ragger.backend import BackendInterface
 from ragger.firmware import Firmware
 from ragger.navigator.navigation_scenario import NavigateWithScenario
 
-from apps.eos import EosClient, ErrorType, MAX_CHUNK_SIZE
+from apps.eos import EosClient, ErrorType, MAX_CHUNK_SIZE, STATUS_OK
 from apps.eos_transaction_builder import Transaction
 from utils import ROOT_SCREENSHOT_PATH, CORPUS_DIR, CORPUS_FILES
 
@@ -27,26 +27,283 @@ def load_transaction_from_file(transaction_filename):
 transactions = list(CORPUS_FILES)
 transactions.remove("transaction_newaccount.json")
 transactions.remove("transaction_unknown.json")
+# Transfers without memo of test_sign_batch_transaction_accepted
+batch_transactions = ["transaction_batch_1.json",
+                      "transaction_batch_2.json",
+                      "transaction_batch_3.json"]
+for filename in batch_transactions + ["transaction_batch_other_sender.json",
+                                      "transaction_batch_no_action.json"]:
+    transactions.remove(filename)
+transactions.remove("transaction_review_queue_full.json")
+transactions.remove("transaction_updateauth_store_full.json")
+
+
+def review_approve_transaction(firmware: Firmware,
+                               scenario_navigator: NavigateWithScenario,
+                               transaction_filename: str):
+    """ Approve the review of a corpus transaction. However it is sent, a transaction is
+    reviewed with the screens recorded by test_sign_transaction_accepted. """
+    folder_name = "test_sign_transaction_accepted/" + transaction_filename.replace(".json", "")
+    if firmware.is_nano:
+        end_text = "^Sign$"
+    else:
+        end_text = "^Hold to sign$"
+    scenario_navigator.review_approve(test_name=folder_name, custom_screen_text=end_text)
 
 
 @pytest.mark.parametrize("transaction_filename", transactions)
-def test_sign_transaction_accepted(test_name: str,
-                                   firmware: Firmware,
+def test_sign_transaction_accepted(firmware: Firmware,
                                    backend: BackendInterface,
                                    scenario_navigator: NavigateWithScenario,
                                    transaction_filename: str):
-    folder_name = test_name + "/" + transaction_filename.replace(".json", "")
+    signing_digest, message = load_transaction_from_file(transaction_filename)
+    client = EosClient(backend)
+    with client.send_async_sign_message(EOS_PATH, message):
+        review_approve_transaction(firmware, scenario_navigator, transaction_filename)
+    response = client.get_async_response().data
+    client.verify_signature(EOS_PATH, signing_digest, response)
+
+
+# The second signature uses the cached signing key, both must verify
+def test_sign_transaction_cached_signing_key(firmware: Firmware,
+                                             backend: BackendInterface,
+                                             scenario_navigator: NavigateWithScenario):
+    signing_digest, message = load_transaction_from_file("transaction.json")
+    client = EosClient(backend)
+    for _ in range(2):
+        with client.send_async_sign_message(EOS_PATH, message, cache_signing_key=True):
+            review_approve_transaction(firmware, scenario_navigator, "transaction.json")
+        response = client.get_async_response().data
+        client.verify_signature(EOS_PATH, signing_digest, response)
+
+
+# The cached signing key is replaced when the path changes, each signature must verify
+# with the key of its own path
+def test_sign_transaction_cached_signing_key_path_change(firmware: Firmware,
+                                                         backend: BackendInterface,
+                                                         scenario_navigator: NavigateWithScenario):
+    other_path = "m/44'/194'/12346'"
+
+    signing_digest, message = load_transaction_from_file("transaction.json")
+    client = EosClient(backend)
+    for path in [EOS_PATH, other_path, EOS_PATH]:
+        with client.send_async_sign_message(path, message, cache_signing_key=True):
+            review_approve_transaction(firmware, scenario_navigator, "transaction.json")
+        response = client.get_async_response().data
+        client.verify_signature(path, signing_digest, response)
+
+
+# The signature is fetched again without a review, as after a lost response
+def test_sign_transaction_get_last_signature(firmware: Firmware,
+                                             backend: BackendInterface,
+                                             scenario_navigator: NavigateWithScenario):
+    signing_digest, message = load_transaction_from_file("transaction.json")
+    client = EosClient(backend)
+    with client.send_async_sign_message(EOS_PATH, message):
+        review_approve_transaction(firmware, scenario_navigator, "transaction.json")
+    response = client.get_async_response().data
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = client.send_get_last_signature(signing_digest)
+    assert rapdu.status == STATUS_OK
+    assert rapdu.data == response
+    assert client.send_get_last_signature(bytes(32)).status == 0x6A80
+
+
+# The transaction is reviewed once and signed with each key
+def test_sign_transaction_multiple_paths(firmware: Firmware,
+                                         backend: BackendInterface,
+                                         scenario_navigator: NavigateWithScenario):
+    other_paths = ["m/44'/194'/12346'", "m/44'/194'/0'/0/1"]
+
+    signing_digest, message = load_transaction_from_file("transaction.json")
+    client = EosClient(backend)
+    with client.send_async_sign_message(EOS_PATH, message, additional_paths=other_paths):
+        review_approve_transaction(firmware, scenario_navigator, "transaction.json")
+    response = client.get_async_response().data
+    assert len(response) == 3 * 65
+    for i, path in enumerate([EOS_PATH] + other_paths):
+        client.verify_signature(path, signing_digest, response[i * 65:(i + 1) * 65])
+
+
+# Packed transactions are reviewed with the same screens as their DER encoded counterpart
+@pytest.mark.parametrize("transaction_filename", ["transaction.json", "transaction_updateauth.json"])
+def test_sign_packed_transaction_accepted(firmware: Firmware,
+                                          backend: BackendInterface,
+                                          scenario_navigator: NavigateWithScenario,
+                                          transaction_filename: str):
+    with open(CORPUS_DIR / transaction_filename, "r", encoding="utf-8") as f:
+        signing_digest, message = Transaction().encode_packed(load(f))
+    client = EosClient(backend)
+    with client.send_async_sign_message(EOS_PATH, message, packed=True):
+        review_approve_transaction(firmware, scenario_navigator, transaction_filename)
+    response = client.get_async_response().data
+    client.verify_signature(EOS_PATH, signing_digest, response)
+
+
+# A chunk sent again after its response was lost is acknowledged without being parsed
+# again
+def test_sign_sequenced_transaction_retransmitted(firmware: Firmware,
+                                                  backend: BackendInterface,
+                                                  scenario_navigator: NavigateWithScenario):
+    signing_digest, message = load_transaction_from_file("transaction_vote_proxy.json")
+    client = EosClient(backend)
+    chunks = client.split_sequenced_message(EOS_PATH, message, 64)
+    assert len(chunks) == 3
+    for p1, chunk in chunks[:-1]:
+        assert client.send_sequenced_chunk(p1, chunk).status == STATUS_OK
+        assert client.send_sequenced_chunk(p1, chunk).status == STATUS_OK
+
+    with client.send_async_sequenced_chunk(*chunks[-1]):
+        review_approve_transaction(firmware, scenario_navigator, "transaction_vote_proxy.json")
+    response = client.get_async_response().data
+    client.verify_signature(EOS_PATH, signing_digest, response)
+
+    # The final chunk is answered with the same signature, without review
+    assert client.send_sequenced_chunk(*chunks[-1]).data == response
+
+
+# Actions reviewed once the transaction is streamed are displayed with the same screens
+@pytest.mark.parametrize("transaction_filename", ["transaction.json", "transaction_vote.json"])
+def test_sign_transaction_review_after_stream(firmware: Firmware,
+                                              backend: BackendInterface,
+                                              scenario_navigator: NavigateWithScenario,
+                                              transaction_filename: str):
+    if firmware == Firmware.NANOS:
+        pytest.skip("Actions can't be queued on Nano S")
 
     signing_digest, message = load_transaction_from_file(transaction_filename)
     client = EosClient(backend)
+    with client.send_async_sign_message(EOS_PATH, message, review_after_stream=True):
+        review_approve_transaction(firmware, scenario_navigator, transaction_filename)
+    response = client.get_async_response().data
+    client.verify_signature(EOS_PATH, signing_digest, response)
+
+
+# The keys of this updateauth are too many to be displayed: the transaction is rejected
+# before its review
+def test_sign_transaction_argument_store_full(backend: BackendInterface):
+    _, message = load_transaction_from_file("transaction_updateauth_store_full.json")
+    client = EosClient(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert client.send_rejected_sign_message(EOS_PATH, message).status == 0x6A80
+
+
+# The actions of this transaction do not fit in the review queue: it is rejected, and can
+# be signed again with a review while streaming
+def test_sign_transaction_review_after_stream_queue_full(firmware: Firmware,
+                                                         backend: BackendInterface):
+    if firmware == Firmware.NANOS:
+        pytest.skip("Actions can't be queued on Nano S")
+
+    _, message = load_transaction_from_file("transaction_review_queue_full.json")
+    client = EosClient(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    # Once the queue is full, the next blocks are rejected too
+    with client.send_async_sign_message(EOS_PATH, message, review_after_stream=True):
+        pass
+    assert client.get_async_response().status == 0x6A80
+
+
+def test_sign_sequenced_transaction_out_of_order(backend: BackendInterface):
+    _, message = load_transaction_from_file("transaction_vote_proxy.json")
+    client = EosClient(backend)
+    chunks = client.split_sequenced_message(EOS_PATH, message, 64)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert client.send_sequenced_chunk(*chunks[0]).status == STATUS_OK
+    assert client.send_sequenced_chunk(*chunks[2]).status == 0x6A80
+
+
+def test_sign_batch_transaction_out_of_order(firmware: Firmware, backend: BackendInterface):
+    _, message = load_transaction_from_file("transaction.json")
+    client = EosClient(backend)
+    # Index 0 of a batch of 2 transactions, then the path and the start of the transaction
+    first = bytes([0, 2]) + pack_derivation_path(EOS_PATH) + message[:64]
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    if firmware == Firmware.NANOS:
+        assert client.send_batch_chunk(0x00, first).status == 0x6B00
+        return
+    assert client.send_batch_chunk(0x00, first).status == STATUS_OK
+    assert client.send_batch_chunk(0x00, bytes([2]) + message).status == 0x6A80
+
+
+# The transfers are reviewed at once, summed per recipient, then each signature is fetched
+# by its digest
+def test_sign_batch_transaction_accepted(test_name: str,
+                                         firmware: Firmware,
+                                         backend: BackendInterface,
+                                         scenario_navigator: NavigateWithScenario):
+    if firmware == Firmware.NANOS:
+        pytest.skip("Batch signing is not available on Nano S")
+
+    client = EosClient(backend)
+    count = len(batch_transactions)
+    digests = []
+    for index, transaction_filename in enumerate(batch_transactions):
+        signing_digest, message = load_transaction_from_file(transaction_filename)
+        digests.append(signing_digest)
+        chunks = client.split_batch_message(EOS_PATH, index, count, message)
+        # The blocks are answered without data, the last one starts the review
+        for p1, chunk in chunks[:-1] if index == count - 1 else chunks:
+            rapdu = client.send_batch_chunk(p1, chunk)
+            assert rapdu.status == STATUS_OK
+            assert len(rapdu.data) == 0
+
     if firmware.is_nano:
         end_text = "^Sign$"
     else:
         end_text = "^Hold to sign$"
-    with client.send_async_sign_message(EOS_PATH, message):
-        scenario_navigator.review_approve(test_name=folder_name, custom_screen_text=end_text)
-    response = client.get_async_response().data
-    client.verify_signature(EOS_PATH, signing_digest, response)
+    with client.send_async_batch_chunk(*chunks[-1]):
+        scenario_navigator.review_approve(test_name=test_name, custom_screen_text=end_text)
+    assert len(client.get_async_response().data) == 0
+
+    # The signatures can be fetched in any order
+    for signing_digest in reversed(digests):
+        response = client.send_get_last_signature(signing_digest).data
+        client.verify_signature(EOS_PATH, signing_digest, response)
+
+    other_digest, _ = load_transaction_from_file("transaction.json")
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert client.send_get_last_signature(other_digest).status == 0x6A80
+
+
+# Only transfers without memo from the sender and on the token contract of the batch are
+# accepted, any other transaction, or one without action, ends the batch
+@pytest.mark.parametrize("transaction_filename", ["transaction.json",
+                                                  "transaction_batch_other_sender.json",
+                                                  "transaction_vote.json",
+                                                  "transaction_batch_no_action.json"])
+def test_sign_batch_transaction_rejected(firmware: Firmware,
+                                         backend: BackendInterface,
+                                         transaction_filename: str):
+    if firmware == Firmware.NANOS:
+        pytest.skip("Batch signing is not available on Nano S")
+
+    first_digest, first_message = load_transaction_from_file(batch_transactions[0])
+    _, message = load_transaction_from_file(transaction_filename)
+    client = EosClient(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    for p1, chunk in client.split_batch_message(EOS_PATH, 0, 2, first_message):
+        assert client.send_batch_chunk(p1, chunk).status == STATUS_OK
+    for p1, chunk in client.split_batch_message(EOS_PATH, 1, 2, message):
+        status = client.send_batch_chunk(p1, chunk).status
+        if status != STATUS_OK:
+            break
+    assert status == 0x6A80
+    assert client.send_get_last_signature(first_digest).status == 0x6985
+
+
+# A batch has to hold a transfer to be reviewed
+def test_sign_batch_transaction_without_action(firmware: Firmware, backend: BackendInterface):
+    if firmware == Firmware.NANOS:
+        pytest.skip("Batch signing is not available on Nano S")
+
+    _, message = load_transaction_from_file("transaction_batch_no_action.json")
+    client = EosClient(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    chunks = client.split_batch_message(EOS_PATH, 0, 1, message)
+    assert len(chunks) == 1
+    assert client.send_batch_chunk(*chunks[0]).status == 0x6A80
 
 
 def test_sign_transaction_refused(test_name: str,